@@ -2,19 +2,36 @@
 #include "NodeVal.h"
 using namespace std;
 
-void AttrMap::copyFrom(const AttrMap &other) {
-    attrMap.clear();
-    for (const auto &loc : other.attrMap) {
-        attrMap.insert({loc.first, make_unique<NodeVal>(*loc.second)});
+AttrMap::AttrMap() = default;
+
+AttrMap::AttrMap(const AttrMap &other) = default;
+
+AttrMap& AttrMap::operator=(const AttrMap &other) = default;
+
+AttrMap::AttrMap(AttrMap &&other) noexcept = default;
+
+AttrMap& AttrMap::operator=(AttrMap &&other) noexcept = default;
+
+AttrMap::~AttrMap() {}
+
+const NodeVal* AttrMap::find(NamePool::Id name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return &vals[i];
     }
+    return nullptr;
 }
 
-AttrMap::AttrMap(const AttrMap &other) {
-    copyFrom(other);
+NodeVal* AttrMap::find(NamePool::Id name) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return &vals[i];
+    }
+    return nullptr;
 }
 
-void AttrMap::operator=(const AttrMap &other) {
-    if (this != &other) copyFrom(other);
-}
+bool AttrMap::insert(NamePool::Id name, NodeVal val) {
+    if (find(name) != nullptr) return false;
 
-AttrMap::~AttrMap() {}
\ No newline at end of file
+    names.push_back(name);
+    vals.push_back(move(val));
+    return true;
+}
\ No newline at end of file
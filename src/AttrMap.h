@@ -1,22 +1,31 @@
 #pragma once
 
-#include <memory>
-#include <unordered_map>
+#include <vector>
 #include "NamePool.h"
 
 class NodeVal;
 
+// nodes carry only a few attributes, so linear lookup in flat storage beats hashing
 struct AttrMap {
-    std::unordered_map<NamePool::Id, std::unique_ptr<NodeVal>, NamePool::Id::Hasher> attrMap;
+    std::vector<NamePool::Id> names;
+    std::vector<NodeVal> vals;
 
-private:
-    void copyFrom(const AttrMap &other);
-
-public:
-    AttrMap() = default;
+    AttrMap();
 
     AttrMap(const AttrMap &other);
-    void operator=(const AttrMap &other);
+    AttrMap& operator=(const AttrMap &other);
+
+    AttrMap(AttrMap &&other) noexcept;
+    AttrMap& operator=(AttrMap &&other) noexcept;
 
     ~AttrMap();
+
+    bool empty() const { return names.empty(); }
+    std::size_t size() const { return names.size(); }
+
+    // returns nullptr if not found
+    const NodeVal* find(NamePool::Id name) const;
+    NodeVal* find(NamePool::Id name);
+    // returns false if an attribute under that name is already present
+    bool insert(NamePool::Id name, NodeVal val);
 };
\ No newline at end of file
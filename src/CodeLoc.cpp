@@ -1,6 +1,14 @@
 #include "CodeLoc.h"
+#include <algorithm>
 using namespace std;
 
+CodeLocPoint CodeLocPoint::make(CodeIndex ln, CodeIndex col) {
+    CodeLocPoint pnt;
+    pnt.ln = min(ln, MAX_LN);
+    pnt.col = min(col, MAX_COL);
+    return pnt;
+}
+
 ostream& operator<<(std::ostream &out, CodeLocPoint locPnt) {
     out << "{ln=" << locPnt.ln << ", col=" << locPnt.col << "}";
     return out;
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include "StringPool.h"
 
 typedef std::size_t CodeIndex;
 
+// packed to keep nodes small, lines and columns past the limits saturate
 struct CodeLocPoint {
-    CodeIndex ln, col;
+    static constexpr CodeIndex MAX_LN = (1 << 20)-1, MAX_COL = (1 << 12)-1;
+
+    std::uint32_t ln : 20, col : 12;
+
+    static CodeLocPoint make(CodeIndex ln, CodeIndex col);
 };
 
 struct CodeLoc {
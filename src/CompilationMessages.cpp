@@ -133,6 +133,9 @@ string CompilationMessages::errorStringOfType(TypeTable::Id ty) const {
             case TypeTable::TypeDescr::Decor::D_PTR:
                 ss << "*";
                 break;
+            case TypeTable::TypeDescr::Decor::D_VEC:
+                ss << "(vec " << descr.decors[i].len << ")";
+                break;
             default:
                 return fallback;
             }
@@ -385,6 +388,24 @@ void CompilationMessages::hintWhileProcessingRetType(CodeLoc loc) {
     info(loc, "Error was encountered while trying to process a function return type.");
 }
 
+void CompilationMessages::hintWhileEvaluatingFunc(CodeLoc loc, NamePool::Id name) {
+    stringstream ss;
+    ss << "While evaluating a call to function '" << namePool->get(name) << "'.";
+    info(loc, ss.str());
+}
+
+void CompilationMessages::hintWhileInvokingMacro(CodeLoc loc, NamePool::Id name) {
+    stringstream ss;
+    ss << "While invoking macro '" << namePool->get(name) << "'.";
+    info(loc, ss.str());
+}
+
+void CompilationMessages::hintEvalFramesOmitted(size_t cnt) {
+    stringstream ss;
+    ss << "And " << cnt << " more outer evaluated calls and macro invocations.";
+    info(ss.str());
+}
+
 void CompilationMessages::warnUnusedSpecial(CodeLoc loc, SpecialVal spec) {
     optional<Keyword> k = getKeyword(spec.id);
 
@@ -567,6 +588,16 @@ void CompilationMessages::errorBadArraySize(CodeLoc loc, long int size) {
     error(loc, ss.str());
 }
 
+void CompilationMessages::errorBadVecSize(CodeLoc loc, long int size) {
+    stringstream ss;
+    ss << "Vector size must be a positive integer. Size " << size << " is invalid.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorBadVecElemType(CodeLoc loc) {
+    error(loc, "Vectors can only be made of numeric, character or boolean primitive types.");
+}
+
 void CompilationMessages::errorNonUnOp(CodeLoc loc, Oper op) {
     stringstream ss;
     ss << "Operation '" << errorStringOfOper(op) << "' is not unary.";
@@ -597,6 +628,12 @@ void CompilationMessages::errorSymGlobalOwning(CodeLoc loc, NamePool::Id name, T
     error(loc, ss.str());
 }
 
+void CompilationMessages::errorSymThreadLocalNotGlobal(CodeLoc loc, NamePool::Id name) {
+    stringstream ss;
+    ss << "Attempted to declare a thread-local symbol '" << namePool->get(name) << "' which is not a compiled global.";
+    error(loc, ss.str());
+}
+
 void CompilationMessages::errorSymbolNotFound(CodeLoc loc, NamePool::Id name) {
     stringstream ss;
     ss << "Symbol with name '" << namePool->get(name) << "' not found.";
@@ -645,6 +682,10 @@ void CompilationMessages::errorExprCmpNeArgNum(CodeLoc loc) {
     error(loc, "Attempted to use '!=' operator on more than two operands.");
 }
 
+void CompilationMessages::errorExprCmpVecArgNum(CodeLoc loc) {
+    error(loc, "Attempted to compare vectors with more than two operands.");
+}
+
 void CompilationMessages::errorExprAddrOfNonRef(CodeLoc loc) {
     error(loc, "Attempted to get a pointer to non-ref value.");
 }
@@ -698,6 +739,18 @@ void CompilationMessages::errorMacroNoRet(CodeLoc loc) {
     error(loc, "Macro execution ended without a ret instruction.");
 }
 
+void CompilationMessages::errorEvalCallDepth(CodeLoc loc, unsigned limit) {
+    stringstream ss;
+    ss << "Evaluated calls and macro invocations were nested deeper than the limit of " << limit << ", see -eval-depth-limit.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorEvalStepLimit(CodeLoc loc, uint64_t limit) {
+    stringstream ss;
+    ss << "Evaluation processed more nodes than the limit of " << limit << ", see -eval-step-limit.";
+    error(loc, ss.str());
+}
+
 void CompilationMessages::errorRetValue(CodeLoc loc) {
     error(loc, "Ret instruction had a return value in a non-returning function.");
 }
@@ -741,6 +794,70 @@ void CompilationMessages::errorFuncNotEvalOrCompiled(CodeLoc loc) {
     error(loc, "Function set as neither evaluable nor compilable.");
 }
 
+void CompilationMessages::errorFuncAttrsConflict(CodeLoc loc, const std::string &attrA, const std::string &attrB) {
+    stringstream ss;
+    ss << "Function cannot be marked as both '" << attrA << "' and '" << attrB << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorNoAliasNonPointer(CodeLoc loc, TypeTable::Id ty) {
+    stringstream ss;
+    ss << "Only pointer arguments can be marked as noAlias, but argument is of type '" << errorStringOfType(ty) << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorMemoizeOwning(CodeLoc loc, TypeTable::Id ty) {
+    stringstream ss;
+    ss << "Memoized functions can only take and return values that need no dropping, but type '" << errorStringOfType(ty) << "' does.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorLoopHintBadValue(CodeLoc loc, NamePool::Id name) {
+    stringstream ss;
+    ss << "Loop hint '" << namePool->get(name) << "' must be a boolean or a positive integer.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorLoopHintsConflict(CodeLoc loc, const std::string &attrA, const std::string &attrB) {
+    stringstream ss;
+    ss << "Block cannot be marked as both '" << attrA << "' and '" << attrB << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorBranchValType(CodeLoc loc, TypeTable::Id ty) {
+    stringstream ss;
+    ss << "Branching is only possible on integer and character values, got '" << errorStringOfType(ty) << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorCondLikelihoodConflict(CodeLoc loc) {
+    error(loc, "Condition cannot be marked as both 'likely' and 'unlikely'.");
+}
+
+void CompilationMessages::errorAtomicUnknownOp(CodeLoc loc, NamePool::Id name) {
+    stringstream ss;
+    ss << "Unknown atomic operation '" << namePool->get(name) << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorAtomicBadType(CodeLoc loc, TypeTable::Id ty) {
+    stringstream ss;
+    ss << "Atomic operation is not possible through a value of type '" << errorStringOfType(ty) << "'.";
+    error(loc, ss.str());
+}
+
+void CompilationMessages::errorAtomicBadOrdering(CodeLoc loc) {
+    error(loc, "Memory ordering is not allowed for this atomic operation.");
+}
+
+void CompilationMessages::errorAtomicOrderingsConflict(CodeLoc loc) {
+    error(loc, "Atomic operation cannot have more than one memory ordering.");
+}
+
+void CompilationMessages::errorAlignBadValue(CodeLoc loc) {
+    error(loc, "Alignment must be a positive power of two.");
+}
+
 void CompilationMessages::errorMacroNameTaken(CodeLoc loc, NamePool::Id name) {
     stringstream ss;
     ss << "Name '" << namePool->get(name) << "' was already taken and cannot be used for a macro.";
@@ -839,6 +956,10 @@ void CompilationMessages::errorBlockBareNameType(CodeLoc loc) {
     error(loc, "Bare blocks cannot have names nor pass types. They are simply unscoped sequences of instructions.");
 }
 
+void CompilationMessages::errorBlockBareLoopHints(CodeLoc loc) {
+    error(loc, "Bare blocks cannot have loop hints, as they cannot be looped.");
+}
+
 void CompilationMessages::errorBlockNotFound(CodeLoc loc, NamePool::Id name) {
     stringstream ss;
     ss << "No enclosing blocks with name '" << namePool->get(name) << "' have been found.";
@@ -901,6 +1022,10 @@ void CompilationMessages::errorExprIndexNull(CodeLoc loc) {
     error(loc, "Attempted to index a null array pointer.");
 }
 
+void CompilationMessages::errorExprPointerOutlivesPointee(CodeLoc loc) {
+    error(loc, "Evaluated pointer would outlive the value it points to.");
+}
+
 void CompilationMessages::errorExprUnOnNull(CodeLoc loc) {
     error(loc, "Operation is not allowed on null literal.");
 }
@@ -1022,6 +1147,10 @@ void CompilationMessages::errorMainNoDef() {
     error("Main function was declared, but not defined.");
 }
 
+void CompilationMessages::errorTempFileNotCreated() {
+    error("Could not create a temporary file.");
+}
+
 void CompilationMessages::errorEvaluationNotSupported(CodeLoc loc) {
     error(loc, "This evaluation is not supported.");
 }
@@ -78,6 +78,9 @@ public:
     void hintIndexTempOwning();
     void hintUnescapeEscaped();
     void hintWhileProcessingRetType(CodeLoc loc);
+    void hintWhileEvaluatingFunc(CodeLoc loc, NamePool::Id name);
+    void hintWhileInvokingMacro(CodeLoc loc, NamePool::Id name);
+    void hintEvalFramesOmitted(std::size_t cnt);
 
     void warnUnusedSpecial(CodeLoc loc, SpecialVal spec);
     void warnUnusedFunc(CodeLoc loc);
@@ -112,11 +115,14 @@ public:
     void errorInvalidTypeArg(CodeLoc loc);
     void errorUndefType(CodeLoc loc, TypeTable::Id ty);
     void errorBadArraySize(CodeLoc loc, long int size);
+    void errorBadVecSize(CodeLoc loc, long int size);
+    void errorBadVecElemType(CodeLoc loc);
     void errorNonUnOp(CodeLoc loc, Oper op);
     void errorNonBinOp(CodeLoc loc, Oper op);
     void errorNameTaken(CodeLoc loc, NamePool::Id name);
     void errorSymCnNoInit(CodeLoc loc, NamePool::Id name);
     void errorSymGlobalOwning(CodeLoc loc, NamePool::Id name, TypeTable::Id ty);
+    void errorSymThreadLocalNotGlobal(CodeLoc loc, NamePool::Id name);
     void errorSymbolNotFound(CodeLoc loc, NamePool::Id name);
     void errorCnNoInit(CodeLoc loc, NamePool::Id name);
     void errorExprCannotPromote(CodeLoc loc);
@@ -126,6 +132,7 @@ public:
     void errorExprBinLeftShiftOfNeg(CodeLoc loc, std::int64_t shift);
     void errorExprBinShiftByNeg(CodeLoc loc, std::int64_t shift);
     void errorExprCmpNeArgNum(CodeLoc loc);
+    void errorExprCmpVecArgNum(CodeLoc loc);
     void errorExprAddrOfNonRef(CodeLoc loc);
     void errorExprCannotCast(CodeLoc loc, TypeTable::Id from, TypeTable::Id into);
     void errorExprCannotImplicitCast(CodeLoc loc, TypeTable::Id from, TypeTable::Id into);
@@ -137,6 +144,7 @@ public:
     void errorExprDerefNull(CodeLoc loc);
     void errorExprIndexNotIntegral(CodeLoc loc);
     void errorExprIndexNull(CodeLoc loc);
+    void errorExprPointerOutlivesPointee(CodeLoc loc);
     void errorExprUnOnNull(CodeLoc loc);
     void errorExprAsgnNonRef(CodeLoc loc);
     void errorExprAsgnOnCn(CodeLoc loc);
@@ -151,6 +159,8 @@ public:
     void errorLoopNowhere(CodeLoc loc);
     void errorFuncNoRet(CodeLoc loc);
     void errorMacroNoRet(CodeLoc loc);
+    void errorEvalCallDepth(CodeLoc loc, unsigned limit);
+    void errorEvalStepLimit(CodeLoc loc, std::uint64_t limit);
     void errorRetValue(CodeLoc loc);
     void errorRetNoValue(CodeLoc loc, TypeTable::Id shouldRet);
     void errorRetNonEval(CodeLoc loc);
@@ -159,6 +169,18 @@ public:
     void errorFuncCollisionNoNameMangle(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorFuncCollision(CodeLoc loc, NamePool::Id name, CodeLoc codeLocOther);
     void errorFuncNotEvalOrCompiled(CodeLoc loc);
+    void errorFuncAttrsConflict(CodeLoc loc, const std::string &attrA, const std::string &attrB);
+    void errorNoAliasNonPointer(CodeLoc loc, TypeTable::Id ty);
+    void errorMemoizeOwning(CodeLoc loc, TypeTable::Id ty);
+    void errorLoopHintBadValue(CodeLoc loc, NamePool::Id name);
+    void errorLoopHintsConflict(CodeLoc loc, const std::string &attrA, const std::string &attrB);
+    void errorBranchValType(CodeLoc loc, TypeTable::Id ty);
+    void errorCondLikelihoodConflict(CodeLoc loc);
+    void errorAtomicUnknownOp(CodeLoc loc, NamePool::Id name);
+    void errorAtomicBadType(CodeLoc loc, TypeTable::Id ty);
+    void errorAtomicBadOrdering(CodeLoc loc);
+    void errorAtomicOrderingsConflict(CodeLoc loc);
+    void errorAlignBadValue(CodeLoc loc);
     void errorMacroNameTaken(CodeLoc loc, NamePool::Id name);
     void errorMacroTypeBadArgNumber(CodeLoc loc);
     void errorMacroArgAfterVariadic(CodeLoc loc);
@@ -176,6 +198,7 @@ public:
     void errorDataCnElement(CodeLoc loc);
     void errorDataRedefinition(CodeLoc loc, NamePool::Id name);
     void errorBlockBareNameType(CodeLoc loc);
+    void errorBlockBareLoopHints(CodeLoc loc);
     void errorBlockNotFound(CodeLoc loc, NamePool::Id name);
     void errorBlockNoPass(CodeLoc loc);
     void errorElementIndexData(CodeLoc loc, NamePool::Id name, TypeTable::Id ty);
@@ -201,6 +224,7 @@ public:
     void errorNotTopmost(CodeLoc loc);
     void errorNoMain();
     void errorMainNoDef();
+    void errorTempFileNotCreated();
     // placeholder error, should not stay in code
     void errorEvaluationNotSupported(CodeLoc loc);
     // placeholder error, should not stay in code
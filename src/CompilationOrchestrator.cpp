@@ -1,9 +1,12 @@
 #include "CompilationOrchestrator.h"
 #include <filesystem>
+#include <fstream>
 #include <stack>
 #include <unordered_map>
 #include "ClangAdapter.h"
 #include "Lexer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
 #include "OrbCompilerConfig.h"
 #include "Parser.h"
 #include "reserved.h"
@@ -16,7 +19,7 @@ CompilationOrchestrator::CompilationOrchestrator(ProgramArgs programArgs, ostrea
     typeTable = make_unique<TypeTable>();
     symbolTable = make_unique<SymbolTable>();
     msgs = make_unique<CompilationMessages>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), out);
-    evaluator = make_unique<Evaluator>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), msgs.get());
+    evaluator = make_unique<Evaluator>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), msgs.get(), args);
     compiler = make_unique<Compiler>(namePool.get(), stringPool.get(), typeTable.get(), symbolTable.get(), msgs.get(), args);
     evaluator->setCompiler(compiler.get());
     compiler->setEvaluator(evaluator.get());
@@ -45,11 +48,21 @@ static void addOper(NamePool *namePool, const std::string &str, Oper o) {
     opers.insert(make_pair(name, o));
 }
 
+static void addAttr(NamePool *namePool, const std::string &str, Attr a) {
+    attrNameIds[(size_t) a] = namePool->add(str);
+}
+
+static void addAtomicOp(NamePool *namePool, const std::string &str, AtomicOp op) {
+    NamePool::Id name = namePool->add(str);
+    atomicOps.insert(make_pair(name, op));
+}
+
 void CompilationOrchestrator::genReserved() {
     addMain(namePool.get());
     addMeaningful(namePool.get(), "cn", Meaningful::CN);
     addMeaningful(namePool.get(), "*", Meaningful::ASTERISK);
     addMeaningful(namePool.get(), "[]", Meaningful::SQUARE);
+    addMeaningful(namePool.get(), "vec", Meaningful::VEC);
     addMeaningful(namePool.get(), "type", Meaningful::TYPE);
 
     addKeyword(namePool.get(), "sym", Keyword::SYM);
@@ -58,6 +71,8 @@ void CompilationOrchestrator::genReserved() {
     addKeyword(namePool.get(), "exit", Keyword::EXIT);
     addKeyword(namePool.get(), "loop", Keyword::LOOP);
     addKeyword(namePool.get(), "pass", Keyword::PASS);
+    addKeyword(namePool.get(), "branch", Keyword::BRANCH);
+    addKeyword(namePool.get(), "atomic", Keyword::ATOMIC);
     addKeyword(namePool.get(), "explicit", Keyword::EXPLICIT);
     addKeyword(namePool.get(), "data", Keyword::DATA);
     addKeyword(namePool.get(), "fnc", Keyword::FNC);
@@ -94,6 +109,60 @@ void CompilationOrchestrator::genReserved() {
     addOper(namePool.get(), "!", Oper::NOT);
     addOper(namePool.get(), "~", Oper::BIT_NOT);
     addOper(namePool.get(), "[]", Oper::IND);
+
+    addAttr(namePool.get(), "bare", Attr::BARE);
+    addAttr(namePool.get(), "global", Attr::GLOBAL);
+    addAttr(namePool.get(), "evaluated", Attr::EVALUATED);
+    addAttr(namePool.get(), "noZero", Attr::NO_ZERO);
+    addAttr(namePool.get(), "threadLocal", Attr::THREAD_LOCAL);
+    addAttr(namePool.get(), "align", Attr::ALIGN);
+    addAttr(namePool.get(), "packed", Attr::PACKED);
+    addAttr(namePool.get(), "noNameMangle", Attr::NO_NAME_MANGLE);
+    addAttr(namePool.get(), "evaluable", Attr::EVALUABLE);
+    addAttr(namePool.get(), "compilable", Attr::COMPILABLE);
+    addAttr(namePool.get(), "inline", Attr::INLINE);
+    addAttr(namePool.get(), "noInline", Attr::NO_INLINE);
+    addAttr(namePool.get(), "flatten", Attr::FLATTEN);
+    addAttr(namePool.get(), "hot", Attr::HOT);
+    addAttr(namePool.get(), "cold", Attr::COLD);
+    addAttr(namePool.get(), "pure", Attr::PURE);
+    addAttr(namePool.get(), "noReturn", Attr::NO_RETURN);
+    addAttr(namePool.get(), "memoize", Attr::MEMOIZE);
+    addAttr(namePool.get(), "variadic", Attr::VARIADIC);
+    addAttr(namePool.get(), "noDrop", Attr::NO_DROP);
+    addAttr(namePool.get(), "noAlias", Attr::NO_ALIAS);
+    addAttr(namePool.get(), "preprocess", Attr::PREPROCESS);
+    addAttr(namePool.get(), "plusEscape", Attr::PLUS_ESCAPE);
+    addAttr(namePool.get(), "warning", Attr::WARNING);
+    addAttr(namePool.get(), "error", Attr::ERROR);
+    addAttr(namePool.get(), "loc", Attr::LOC);
+    addAttr(namePool.get(), "noWrap", Attr::NO_WRAP);
+    addAttr(namePool.get(), "likely", Attr::LIKELY);
+    addAttr(namePool.get(), "unlikely", Attr::UNLIKELY);
+    addAttr(namePool.get(), "vectorize", Attr::VECTORIZE);
+    addAttr(namePool.get(), "unroll", Attr::UNROLL);
+    addAttr(namePool.get(), "noUnroll", Attr::NO_UNROLL);
+    addAttr(namePool.get(), "interleave", Attr::INTERLEAVE);
+    addAttr(namePool.get(), "parallelAccesses", Attr::PARALLEL_ACCESSES);
+    addAttr(namePool.get(), "relaxed", Attr::RELAXED);
+    addAttr(namePool.get(), "acquire", Attr::ACQUIRE);
+    addAttr(namePool.get(), "release", Attr::RELEASE);
+    addAttr(namePool.get(), "acqRel", Attr::ACQ_REL);
+    addAttr(namePool.get(), "seqCst", Attr::SEQ_CST);
+    addAttr(namePool.get(), "weak", Attr::WEAK);
+
+    addAtomicOp(namePool.get(), "load", AtomicOp::LOAD);
+    addAtomicOp(namePool.get(), "store", AtomicOp::STORE);
+    addAtomicOp(namePool.get(), "xchg", AtomicOp::XCHG);
+    addAtomicOp(namePool.get(), "add", AtomicOp::ADD);
+    addAtomicOp(namePool.get(), "sub", AtomicOp::SUB);
+    addAtomicOp(namePool.get(), "and", AtomicOp::AND);
+    addAtomicOp(namePool.get(), "or", AtomicOp::OR);
+    addAtomicOp(namePool.get(), "xor", AtomicOp::XOR);
+    addAtomicOp(namePool.get(), "min", AtomicOp::MIN);
+    addAtomicOp(namePool.get(), "max", AtomicOp::MAX);
+    addAtomicOp(namePool.get(), "cmpxchg", AtomicOp::CMPXCHG);
+    addAtomicOp(namePool.get(), "fence", AtomicOp::FENCE);
 }
 
 void CompilationOrchestrator::genPrimTypes() {
@@ -252,6 +321,7 @@ bool CompilationOrchestrator::process() {
         } else if (imres == ITR_COMPLETED) {
             continue;
         } else {
+            processedFiles.push_back(path);
             trace.push(par.getLexer());
         }
 
@@ -288,6 +358,7 @@ bool CompilationOrchestrator::process() {
                     }
 
                     if (imres == ITR_STARTED) {
+                        processedFiles.push_back(path);
                         trace.push(par.getLexer());
                     }
                     break;
@@ -299,9 +370,40 @@ bool CompilationOrchestrator::process() {
     return true;
 }
 
+void CompilationOrchestrator::printEvalProfile(ostream &out) const {
+    if (!args.evalProfile) return;
+
+    evaluator->printProfile(out);
+}
+
+static string escapeForMake(const string &path) {
+    string escaped;
+    for (char c : path) {
+        if (c == ' ' || c == '#') escaped += '\\';
+        else if (c == '$') escaped += '$';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void CompilationOrchestrator::printDeps(const std::string &filename) const {
+    ofstream file(filename);
+    if (!file) {
+        cerr << "Could not open file: " << filename << endl;
+        return;
+    }
+
+    file << escapeForMake(args.outputBin) << ":";
+    for (const string &path : processedFiles) {
+        file << " \\\n  " << escapeForMake(path);
+    }
+    file << endl;
+}
+
 void CompilationOrchestrator::printout() const {
-    if (args.outputLlvm.has_value()) {
-        compiler->printout(args.outputLlvm.value());
+    // LLVM IR is printed by compiler when compiling
+    if (args.outputDep.has_value()) {
+        printDeps(args.outputDep.value());
     }
 }
 
@@ -318,13 +420,17 @@ bool CompilationOrchestrator::compile() {
             return false;
         }
 
-        const static string tempObjName = PLATFORM_WINDOWS ? "a.obj" : "a.o";
-
-        if (!compiler->binary(tempObjName)) return false;
+        // unique name, so that concurrent runs in the same directory don't clobber each other
+        llvm::SmallString<128> tempObjPath;
+        if (llvm::sys::fs::createTemporaryFile("orbc", PLATFORM_WINDOWS ? "obj" : "o", tempObjPath)) {
+            msgs->errorTempFileNotCreated();
+            return false;
+        }
+        const string tempObjName = tempObjPath.str().str();
 
-        bool success = buildExecutable(args, tempObjName);
+        bool success = compiler->binary(tempObjName) && buildExecutable(args, tempObjName);
 
-        remove(tempObjName.c_str());
+        llvm::sys::fs::remove(tempObjName);
         return success;
     } else {
         return buildExecutable(args, "");
@@ -19,14 +19,19 @@ class CompilationOrchestrator {
     std::unique_ptr<CompilationMessages> msgs;
     std::unique_ptr<Compiler> compiler;
     std::unique_ptr<Evaluator> evaluator;
+    // all source files that were opened, in order
+    std::vector<std::string> processedFiles;
 
     void genReserved();
     void genPrimTypes();
 
+    void printDeps(const std::string &filename) const;
+
 public:
     CompilationOrchestrator(ProgramArgs programArgs, std::ostream &out);
 
     bool process();
+    void printEvalProfile(std::ostream &out) const;
     void printout() const;
     bool compile();
 
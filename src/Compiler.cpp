@@ -1,15 +1,26 @@
 #include "Compiler.h"
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <sstream>
+#include <unordered_set>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "BlockRaii.h"
+#include "OrbCompilerConfig.h"
 using namespace std;
 
 Compiler::Compiler(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args)
@@ -20,13 +31,23 @@ Compiler::Compiler(NamePool *namePool, StringPool *stringPool, TypeTable *typeTa
 
     llvmPmb = make_unique<llvm::PassManagerBuilder>();
     if (args.optLvl.has_value()) llvmPmb->OptLevel = args.optLvl.value();
+    // without an inliner, fnc::inline and fnc::flatten would have no effect
+    if (llvmPmb->OptLevel > 0) {
+        llvmPmb->Inliner = llvm::createFunctionInliningPass(llvmPmb->OptLevel, llvmPmb->SizeLevel, false);
+    } else {
+        llvmPmb->Inliner = llvm::createAlwaysInlinerLegacyPass();
+    }
+    llvmPmb->LoopVectorize = llvmPmb->OptLevel > 1;
+    llvmPmb->SLPVectorize = llvmPmb->OptLevel > 1;
     llvmFpm = make_unique<llvm::legacy::FunctionPassManager>(llvmModule.get());
     llvmPmb->populateFunctionPassManager(*llvmFpm);
 
     link = args.link;
+    cacheDir = args.cacheDir;
+    outputLlvm = args.outputLlvm;
 }
 
-void Compiler::printout(const std::string &filename) const {
+void Compiler::printout(const std::string &filename) {
     std::error_code errorCode;
     llvm::raw_fd_ostream dest(filename, errorCode, llvm::sys::fs::F_None);
     if (errorCode) {
@@ -42,6 +63,33 @@ bool Compiler::binary(const std::string &filename) {
         return false;
     }
 
+    // fingerprinted before optimizing, so that a cache hit skips all passes
+    optional<string> cachedFilename;
+    bool cacheHit = false;
+    if (cacheDir.has_value()) {
+        cachedFilename = makeCachedObjectFilename();
+        if (filesystem::exists(cachedFilename.value())) {
+            std::error_code errorCode;
+            filesystem::copy_file(cachedFilename.value(), filename, filesystem::copy_options::overwrite_existing, errorCode);
+            cacheHit = !errorCode;
+        }
+    }
+
+    // on a cache hit, optimizing is still needed to print the same IR as on a miss
+    if (cacheHit && !outputLlvm.has_value()) return true;
+
+    finalizeModule();
+    // printed before codegen, as it rewrites the IR in target-specific ways
+    if (outputLlvm.has_value()) printout(outputLlvm.value());
+    if (cacheHit) return true;
+
+    if (!emitObjectFile(filename)) return false;
+
+    if (cachedFilename.has_value()) storeInCache(filename, cachedFilename.value());
+    return true;
+}
+
+bool Compiler::emitObjectFile(const std::string &filename) {
     std::error_code errorCode;
     llvm::raw_fd_ostream dest(filename, errorCode, llvm::sys::fs::F_None);
     if (errorCode) {
@@ -50,7 +98,6 @@ bool Compiler::binary(const std::string &filename) {
     }
 
     llvm::legacy::PassManager llvmPm;
-    llvmPmb->populateModulePassManager(llvmPm);
 
     llvm::CodeGenFileType fileType = llvm::CGFT_ObjectFile;
 
@@ -144,22 +191,22 @@ NodeVal Compiler::performZero(CodeLoc codeLoc, TypeTable::Id ty) {
     return NodeVal(codeLoc, llvmVal);
 }
 
-NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) {
+NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty, SymAttrs attrs) {
     llvm::Type *llvmType = makeLlvmTypeOrError(codeLocTy, ty);
     if (llvmType == nullptr) return NodeVal();
 
     LlvmVal llvmVal(ty);
     if (symbolTable->inGlobalScope()) {
-        llvmVal.ref = makeLlvmGlobal(llvmType, nullptr, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
+        llvmVal.ref = makeLlvmGlobal(llvmType, nullptr, typeTable->worksAsTypeCn(ty), getNameForLlvm(id), getAlignmentFor(ty, attrs.align), attrs.threadLocal);
     } else {
-        llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id));
+        llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id), getAlignmentFor(ty, attrs.align));
     }
     llvmVal.lifetimeInfo.nestLevel = symbolTable->currNestLevel();
 
     return NodeVal(codeLoc, llvmVal);
 }
 
-NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) {
+NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init, SymAttrs attrs) {
     NodeVal promo = promoteIfEvalValAndCheckIsLlvmVal(init, true);
     if (promo.isInvalid()) return NodeVal();
 
@@ -169,9 +216,9 @@ NodeVal Compiler::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init
 
     LlvmVal llvmVal(ty);
     if (symbolTable->inGlobalScope()) {
-        llvmVal.ref = makeLlvmGlobal(llvmType, (llvm::Constant*) promo.getLlvmVal().val, typeTable->worksAsTypeCn(ty), getNameForLlvm(id));
+        llvmVal.ref = makeLlvmGlobal(llvmType, (llvm::Constant*) promo.getLlvmVal().val, typeTable->worksAsTypeCn(ty), getNameForLlvm(id), getAlignmentFor(ty, attrs.align), attrs.threadLocal);
     } else {
-        llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id));
+        llvmVal.ref = makeLlvmAlloca(llvmType, getNameForLlvm(id), getAlignmentFor(ty, attrs.align));
         llvmBuilder.CreateStore(promo.getLlvmVal().val, llvmVal.ref);
     }
     llvmVal.lifetimeInfo.nestLevel = symbolTable->currNestLevel();
@@ -223,6 +270,11 @@ bool Compiler::performBlockSetUp(CodeLoc codeLoc, SymbolTable::Block &block) {
     block.blockExit = llvmBlockAfter;
     block.phi = llvmPhi;
 
+    if (!block.loopHints.isEmpty()) {
+        if (block.loopHints.parallelAccesses) block.llvmAccessGroup = llvm::MDNode::getDistinct(llvmContext, {});
+        block.llvmLoopMd = makeLlvmLoopMd(block.loopHints, block.llvmAccessGroup);
+    }
+
     return true;
 }
 
@@ -250,6 +302,23 @@ NodeVal Compiler::performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block
         llvmBuilder.CreateBr(block.blockExit);
     }
 
+    // llvm blocks from the body up to the exit belong to this block
+    // the promise is only about memory accessed through pointers, so calls, atomics, locals and globals are excluded
+    if (block.llvmAccessGroup != nullptr) {
+        for (auto it = block.blockLoop->getIterator(); it != getLlvmCurrFunction()->end() && &*it != block.blockExit; ++it) {
+            for (llvm::Instruction &llvmInstr : *it) {
+                bool isSimpleLoadStore = (llvm::isa<llvm::LoadInst>(llvmInstr) && llvm::cast<llvm::LoadInst>(llvmInstr).isSimple()) ||
+                    (llvm::isa<llvm::StoreInst>(llvmInstr) && llvm::cast<llvm::StoreInst>(llvmInstr).isSimple());
+                if (!isSimpleLoadStore) continue;
+
+                const llvm::Value *llvmObj = llvm::getUnderlyingObject(llvm::getLoadStorePointerOperand(&llvmInstr));
+                if (llvm::isa<llvm::AllocaInst>(llvmObj) || llvm::isa<llvm::GlobalVariable>(llvmObj)) continue;
+
+                llvmInstr.setMetadata(llvm::LLVMContext::MD_access_group, block.llvmAccessGroup);
+            }
+        }
+    }
+
     getLlvmCurrFunction()->getBasicBlockList().push_back(block.blockExit);
     llvmBuilder.SetInsertPoint(block.blockExit);
 
@@ -262,12 +331,12 @@ NodeVal Compiler::performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block
     }
 }
 
-bool Compiler::performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
-    return doCondBlockJump(codeLoc, cond, block.name, block.blockExit);
+bool Compiler::performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, optional<bool> likely) {
+    return doCondBlockJump(codeLoc, cond, block.name, block.blockExit, likely);
 }
 
-bool Compiler::performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
-    return doCondBlockJump(codeLoc, cond, block.name, block.blockLoop);
+bool Compiler::performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, optional<bool> likely) {
+    return doCondBlockJump(codeLoc, cond, block.name, block.blockLoop, likely, block.llvmLoopMd);
 }
 
 bool Compiler::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) {
@@ -285,6 +354,80 @@ bool Compiler::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal va
     return true;
 }
 
+bool Compiler::performBranch(CodeLoc codeLoc, const NodeVal &val, const vector<vector<NodeVal>> &caseVals, const vector<const NodeVal*> &bodies) {
+    if (!checkInLocalScope(codeLoc, true)) return false;
+
+    NodeVal valPromo = promoteIfEvalValAndCheckIsLlvmVal(val, true);
+    if (valPromo.isInvalid()) return false;
+
+    bool allConst = true;
+    vector<vector<llvm::Value*>> llvmCaseVals(caseVals.size());
+    for (size_t i = 0; i < caseVals.size(); ++i) {
+        for (const NodeVal &caseVal : caseVals[i]) {
+            NodeVal caseValPromo = promoteIfEvalValAndCheckIsLlvmVal(caseVal, true);
+            if (caseValPromo.isInvalid()) return false;
+
+            llvmCaseVals[i].push_back(caseValPromo.getLlvmVal().val);
+            if (!llvm::isa<llvm::ConstantInt>(llvmCaseVals[i].back())) allConst = false;
+        }
+    }
+
+    llvm::Function *llvmFunc = getLlvmCurrFunction();
+
+    vector<llvm::BasicBlock*> llvmBlocksBody(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        llvmBlocksBody[i] = llvm::BasicBlock::Create(llvmContext, i < caseVals.size() ? "case" : "default");
+    }
+    llvm::BasicBlock *llvmBlockAfter = llvm::BasicBlock::Create(llvmContext, "after");
+    llvm::BasicBlock *llvmBlockDefault = bodies.size() > caseVals.size() ? llvmBlocksBody.back() : llvmBlockAfter;
+
+    if (allConst) {
+        // lets llvm pick between jump tables, bit tests, and binary search
+        llvm::SwitchInst *llvmSwitch = llvmBuilder.CreateSwitch(valPromo.getLlvmVal().val, llvmBlockDefault);
+
+        // on duplicate values, the first case wins
+        unordered_set<llvm::ConstantInt*> seen;
+        for (size_t i = 0; i < caseVals.size(); ++i) {
+            for (llvm::Value *llvmCaseVal : llvmCaseVals[i]) {
+                llvm::ConstantInt *llvmConst = llvm::cast<llvm::ConstantInt>(llvmCaseVal);
+                if (!seen.insert(llvmConst).second) continue;
+
+                llvmSwitch->addCase(llvmConst, llvmBlocksBody[i]);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < caseVals.size(); ++i) {
+            for (size_t j = 0; j < caseVals[i].size(); ++j) {
+                llvm::Value *llvmCond = makeLlvmComparison(valPromo.getLlvmVal().val, llvmCaseVals[i][j], valPromo.getType().value(), Oper::EQ);
+                if (llvmCond == nullptr) {
+                    msgs->errorInternal(caseVals[i][j].getCodeLoc());
+                    return false;
+                }
+
+                llvm::BasicBlock *llvmBlockNext = llvm::BasicBlock::Create(llvmContext, "next", llvmFunc);
+                llvmBuilder.CreateCondBr(llvmCond, llvmBlocksBody[i], llvmBlockNext);
+                llvmBuilder.SetInsertPoint(llvmBlockNext);
+            }
+        }
+
+        llvmBuilder.CreateBr(llvmBlockDefault);
+    }
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        llvmFunc->getBasicBlockList().push_back(llvmBlocksBody[i]);
+        llvmBuilder.SetInsertPoint(llvmBlocksBody[i]);
+
+        if (processBlockNonBare(bodies[i]->getCodeLoc(), SymbolTable::Block(), *bodies[i]).isInvalid()) return false;
+
+        if (!isLlvmBlockTerminated()) llvmBuilder.CreateBr(llvmBlockAfter);
+    }
+
+    llvmFunc->getBasicBlockList().push_back(llvmBlockAfter);
+    llvmBuilder.SetInsertPoint(llvmBlockAfter);
+
+    return true;
+}
+
 bool Compiler::performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) {
     // replace a previous compiled declaration with a definition
     if (typeTable->getLlvmType(ty) != nullptr) {
@@ -363,6 +506,28 @@ bool Compiler::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
         func.llvmFunc = llvm::Function::Create(llvmFuncType, llvm::Function::LinkageTypes::ExternalLinkage, funcLlvmName.value(), llvmModule.get());
     }
 
+    if (func.hints.inline_) func.llvmFunc->addFnAttr(llvm::Attribute::InlineHint);
+    if (func.hints.noInline) func.llvmFunc->addFnAttr(llvm::Attribute::NoInline);
+    if (func.hints.hot) func.llvmFunc->addFnAttr(llvm::Attribute::Hot);
+    if (func.hints.cold) func.llvmFunc->addFnAttr(llvm::Attribute::Cold);
+    if (func.hints.pure) func.llvmFunc->addFnAttr(llvm::Attribute::ReadOnly);
+    if (func.hints.noReturn) func.llvmFunc->addFnAttr(llvm::Attribute::NoReturn);
+
+    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+    for (size_t i = 0; i < callable.getArgCnt() && i < func.llvmFunc->arg_size(); ++i) {
+        TypeTable::Id argTy = callable.getArgType(i);
+
+        if (i < func.argNoAliases.size() && func.argNoAliases[i]) func.llvmFunc->addParamAttr(i, llvm::Attribute::NoAlias);
+
+        optional<TypeTable::Id> pointeeTy;
+        if (typeTable->worksAsTypeP(argTy)) pointeeTy = typeTable->addTypeDerefOf(argTy);
+        else if (typeTable->worksAsTypeArrP(argTy)) pointeeTy = typeTable->addTypeIndexOf(argTy);
+        if (!pointeeTy.has_value()) continue;
+
+        // cn data must not be written to through the pointer, even after casting cn away
+        if (typeTable->worksAsTypeCn(pointeeTy.value())) func.llvmFunc->addParamAttr(i, llvm::Attribute::ReadOnly);
+    }
+
     return true;
 }
 
@@ -387,7 +552,7 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
         llvm::Type *llvmArgType = makeLlvmTypeOrError(args.getChild(i).getCodeLoc(), callable.getArgType(i));
         if (llvmArgType == nullptr) return false;
 
-        llvm::AllocaInst *llvmAlloca = makeLlvmAlloca(llvmArgType, getNameForLlvm(func.argNames[i]));
+        llvm::AllocaInst *llvmAlloca = makeLlvmAlloca(llvmArgType, getNameForLlvm(func.argNames[i]), getAlignmentFor(callable.getArgType(i)));
         llvmBuilder.CreateStore(&llvmFuncArg, llvmAlloca);
 
         LlvmVal varLlvmVal(callable.getArgType(i));
@@ -424,8 +589,21 @@ bool Compiler::performFunctionDefinition(CodeLoc codeLoc, const NodeVal &args, c
         }
     }
 
+    removeUnusedAggregateLoads(func.llvmFunc);
+
+    // llvm has no function attribute for this, so every call inside gets inlined instead
+    if (func.hints.flatten) {
+        for (llvm::BasicBlock &llvmBlock : *func.llvmFunc) {
+            for (llvm::Instruction &llvmInstr : llvmBlock) {
+                if (auto *llvmCall = llvm::dyn_cast<llvm::CallInst>(&llvmInstr)) {
+                    llvmCall->addAttribute(llvm::AttributeList::FunctionIndex, llvm::Attribute::AlwaysInline);
+                }
+            }
+        }
+    }
+
+    // function passes are run in finalizeModule, once it's known which functions are used
     if (llvm::verifyFunction(*func.llvmFunc, &llvm::errs())) cerr << endl;
-    llvmFpm->run(*func.llvmFunc);
 
     if (prevLlvmBuilderInsertPoint != nullptr) llvmBuilder.SetInsertPoint(prevLlvmBuilderInsertPoint);
     if (prevLlvmBuilderAllocaInsertPoint != nullptr) llvmBuilderAlloca.SetInsertPoint(prevLlvmBuilderAllocaInsertPoint);
@@ -467,28 +645,32 @@ NodeVal Compiler::performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) {
 
     TypeTable::Id operTy = promo.getLlvmVal().type;
 
+    // vectors are operated on lane by lane
+    TypeTable::Id elemTy = operTy;
+    if (typeTable->worksAsTypeVec(elemTy)) elemTy = typeTable->addTypeIndexOf(elemTy).value();
+
     llvm::Value *llvmIn = promo.getLlvmVal().val, *llvmInRef = promo.getLlvmVal().ref;
     LlvmVal llvmVal(operTy);
     bool errorGiven = false;
     if (op == Oper::ADD) {
-        if (typeTable->worksAsTypeI(operTy) ||
-            typeTable->worksAsTypeU(operTy) ||
-            typeTable->worksAsTypeF(operTy)) {
+        if (typeTable->worksAsTypeI(elemTy) ||
+            typeTable->worksAsTypeU(elemTy) ||
+            typeTable->worksAsTypeF(elemTy)) {
             llvmVal.val = llvmIn;
         }
     } else if (op == Oper::SUB) {
-        if (typeTable->worksAsTypeI(operTy)) {
+        if (typeTable->worksAsTypeI(elemTy)) {
             llvmVal.val = llvmBuilder.CreateNeg(llvmIn, "sneg_tmp");
-        } else if (typeTable->worksAsTypeF(operTy)) {
+        } else if (typeTable->worksAsTypeF(elemTy)) {
             llvmVal.val = llvmBuilder.CreateFNeg(llvmIn, "fneg_tmp");
         }
     } else if (op == Oper::BIT_NOT) {
-        if (typeTable->worksAsTypeI(operTy) ||
-            typeTable->worksAsTypeU(operTy)) {
+        if (typeTable->worksAsTypeI(elemTy) ||
+            typeTable->worksAsTypeU(elemTy)) {
             llvmVal.val = llvmBuilder.CreateNot(llvmIn, "bit_not_tmp");
         }
     } else if (op == Oper::NOT) {
-        if (typeTable->worksAsTypeB(operTy)) {
+        if (typeTable->worksAsTypeB(elemTy)) {
             llvmVal.val = llvmBuilder.CreateNot(llvmIn, "not_tmp");
         }
     } else if (op == Oper::BIT_AND) {
@@ -544,80 +726,7 @@ optional<bool> Compiler::performOperComparison(CodeLoc codeLoc, const NodeVal &l
     NodeVal rhsPromo = promoteIfEvalValAndCheckIsLlvmVal(rhs, true);
     if (rhsPromo.isInvalid()) return nullopt;
 
-    bool isTypeI = typeTable->worksAsTypeI(lhsPromo.getType().value());
-    bool isTypeU = typeTable->worksAsTypeU(lhsPromo.getType().value());
-    bool isTypeC = typeTable->worksAsTypeC(lhsPromo.getType().value());
-    bool isTypeF = typeTable->worksAsTypeF(lhsPromo.getType().value());
-    bool isTypeAnyP = typeTable->worksAsTypeAnyP(lhsPromo.getType().value());
-    bool isTypeB = typeTable->worksAsTypeB(lhsPromo.getType().value());
-    bool isTypeCall = typeTable->worksAsCallable(lhsPromo.getType().value());
-
-    llvm::Value *llvmValueRes = nullptr;
-
-    switch (op) {
-    case Oper::EQ:
-        if (isTypeI || isTypeU || isTypeC || isTypeB) {
-            llvmValueRes = llvmBuilder.CreateICmpEQ(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "cmp_eq_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpOEQ(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_eq_tmp");
-        } else if (isTypeAnyP || isTypeCall) {
-            llvmValueRes = llvmBuilder.CreateICmpEQ(
-                llvmBuilder.CreatePtrToInt(lhsPromo.getLlvmVal().val, makeLlvmPrimType(TypeTable::WIDEST_I)),
-                llvmBuilder.CreatePtrToInt(rhsPromo.getLlvmVal().val, makeLlvmPrimType(TypeTable::WIDEST_I)),
-                "pcmp_eq_tmp");
-        }
-        break;
-    case Oper::NE:
-        if (isTypeI || isTypeU || isTypeC || isTypeB) {
-            llvmValueRes = llvmBuilder.CreateICmpNE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "cmp_ne_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpONE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_ne_tmp");
-        } else if (isTypeAnyP || isTypeCall) {
-            llvmValueRes = llvmBuilder.CreateICmpNE(
-                llvmBuilder.CreatePtrToInt(lhsPromo.getLlvmVal().val, makeLlvmPrimType(TypeTable::WIDEST_I)),
-                llvmBuilder.CreatePtrToInt(rhsPromo.getLlvmVal().val, makeLlvmPrimType(TypeTable::WIDEST_I)),
-                "pcmp_ne_tmp");
-        }
-        break;
-    case Oper::LT:
-        if (isTypeI) {
-            llvmValueRes = llvmBuilder.CreateICmpSLT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "scmp_lt_tmp");
-        } else if (isTypeU || isTypeC) {
-            llvmValueRes = llvmBuilder.CreateICmpULT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "ucmp_lt_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpOLT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_lt_tmp");
-        }
-        break;
-    case Oper::LE:
-        if (isTypeI) {
-            llvmValueRes = llvmBuilder.CreateICmpSLE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "scmp_le_tmp");
-        } else if (isTypeU || isTypeC) {
-            llvmValueRes = llvmBuilder.CreateICmpULE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "ucmp_le_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpOLE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_le_tmp");
-        }
-        break;
-    case Oper::GT:
-        if (isTypeI) {
-            llvmValueRes = llvmBuilder.CreateICmpSGT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "scmp_gt_tmp");
-        } else if (isTypeU || isTypeC) {
-            llvmValueRes = llvmBuilder.CreateICmpUGT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "ucmp_gt_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpOGT(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_gt_tmp");
-        }
-        break;
-    case Oper::GE:
-        if (isTypeI) {
-            llvmValueRes = llvmBuilder.CreateICmpSGE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "scmp_ge_tmp");
-        } else if (isTypeU || isTypeC) {
-            llvmValueRes = llvmBuilder.CreateICmpUGE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "ucmp_ge_tmp");
-        } else if (isTypeF) {
-            llvmValueRes = llvmBuilder.CreateFCmpOGE(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, "fcmp_ge_tmp");
-        }
-        break;
-    default:
-        break;
-    }
+    llvm::Value *llvmValueRes = makeLlvmComparison(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, lhsPromo.getType().value(), op);
 
     if (llvmValueRes == nullptr) {
         msgs->errorExprBadOps(rhs.getCodeLoc(), op, false, lhs.getType().value(), false);
@@ -653,6 +762,27 @@ NodeVal Compiler::performOperComparisonTearDown(CodeLoc codeLoc, bool success, C
     return NodeVal(codeLoc, llvmVal);
 }
 
+NodeVal Compiler::performOperComparisonVec(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, TypeTable::Id resTy) {
+    if (!checkInLocalScope(codeLoc, true)) return NodeVal();
+
+    NodeVal lhsPromo = promoteIfEvalValAndCheckIsLlvmVal(lhs, true);
+    if (lhsPromo.isInvalid()) return NodeVal();
+
+    NodeVal rhsPromo = promoteIfEvalValAndCheckIsLlvmVal(rhs, true);
+    if (rhsPromo.isInvalid()) return NodeVal();
+
+    TypeTable::Id elemTy = typeTable->addTypeIndexOf(lhsPromo.getType().value()).value();
+
+    LlvmVal llvmVal(resTy);
+    llvmVal.val = makeLlvmComparison(lhsPromo.getLlvmVal().val, rhsPromo.getLlvmVal().val, elemTy, op);
+    if (llvmVal.val == nullptr) {
+        msgs->errorExprBadOps(rhs.getCodeLoc(), op, false, lhs.getType().value(), false);
+        return NodeVal();
+    }
+
+    return NodeVal(codeLoc, llvmVal);
+}
+
 NodeVal Compiler::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) {
     if (!checkInLocalScope(codeLoc, true)) return NodeVal();
 
@@ -696,13 +826,27 @@ NodeVal Compiler::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Node
             if (llvmTypeBase == nullptr) return NodeVal();
 
             // llvm's extractvalue would require compile-time constant indices
-            llvm::Value *tmp = makeLlvmAlloca(llvmTypeBase, "tmp");
+            llvm::Value *tmp = makeLlvmAlloca(llvmTypeBase, "tmp", getAlignmentFor(basePromo.getType().value()));
             llvmBuilder.CreateStore(basePromo.getLlvmVal().val, tmp);
             tmp = llvmBuilder.CreateGEP(tmp,
                 {llvm::ConstantInt::get(llvmTypeInd, 0), indPromo.getLlvmVal().val});
             llvmVal.val = llvmBuilder.CreateLoad(tmp, "index_tmp");
         }
 
+        llvmVal.lifetimeInfo = basePromo.getLlvmVal().lifetimeInfo;
+    } else if (typeTable->worksAsTypeVec(basePromo.getType().value())) {
+        // bool lanes are bit-packed in memory, so they cannot be referenced
+        if (basePromo.hasRef() && !typeTable->worksAsTypeB(resTy)) {
+            llvm::Type *llvmTypeInd = makeLlvmTypeOrError(indPromo.getCodeLoc(), indPromo.getType().value());
+            if (llvmTypeInd == nullptr) return NodeVal();
+
+            llvmVal.ref = llvmBuilder.CreateGEP(basePromo.getLlvmVal().ref,
+                {llvm::ConstantInt::get(llvmTypeInd, 0), indPromo.getLlvmVal().val});
+            llvmVal.val = llvmBuilder.CreateLoad(llvmVal.ref, "index_tmp");
+        } else {
+            llvmVal.val = llvmBuilder.CreateExtractElement(basePromo.getLlvmVal().val, indPromo.getLlvmVal().val, "index_tmp");
+        }
+
         llvmVal.lifetimeInfo = basePromo.getLlvmVal().lifetimeInfo;
     } else {
         msgs->errorInternal(codeLoc);
@@ -740,9 +884,13 @@ NodeVal Compiler::performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const
 
     LlvmVal llvmVal(lhs.getType().value());
 
-    bool isTypeI = typeTable->worksAsTypeI(llvmVal.type);
-    bool isTypeU = typeTable->worksAsTypeU(llvmVal.type);
-    bool isTypeF = typeTable->worksAsTypeF(llvmVal.type);
+    // vectors are operated on lane by lane
+    TypeTable::Id ty = llvmVal.type;
+    if (typeTable->worksAsTypeVec(ty)) ty = typeTable->addTypeIndexOf(ty).value();
+
+    bool isTypeI = typeTable->worksAsTypeI(ty);
+    bool isTypeU = typeTable->worksAsTypeU(ty);
+    bool isTypeF = typeTable->worksAsTypeF(ty);
 
     switch (op) {
     case Oper::ADD:
@@ -835,7 +983,118 @@ optional<uint64_t> Compiler::performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) {
     return targetMachine->createDataLayout().getTypeAllocSize(llvmType).getFixedSize();
 }
 
-bool Compiler::doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, optional<NamePool::Id> blockName, llvm::BasicBlock *llvmBlock) {
+NodeVal Compiler::performAtomicLoad(CodeLoc codeLoc, const NodeVal &ptr, TypeTable::Id resTy, AtomicAttrs attrs) {
+    if (!checkInLocalScope(codeLoc, true)) return NodeVal();
+
+    NodeVal ptrPromo = promoteIfEvalValAndCheckIsLlvmVal(ptr, true);
+    if (ptrPromo.isInvalid()) return NodeVal();
+
+    llvm::LoadInst *llvmLoad = llvmBuilder.CreateLoad(ptrPromo.getLlvmVal().val, "atomic_tmp");
+    llvmLoad->setAtomic(makeLlvmAtomicOrdering(attrs.ordering));
+
+    LlvmVal llvmVal(resTy);
+    llvmVal.val = llvmLoad;
+    return NodeVal(codeLoc, llvmVal);
+}
+
+bool Compiler::performAtomicStore(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicAttrs attrs) {
+    if (!checkInLocalScope(codeLoc, true)) return false;
+
+    NodeVal ptrPromo = promoteIfEvalValAndCheckIsLlvmVal(ptr, true);
+    if (ptrPromo.isInvalid()) return false;
+
+    NodeVal valPromo = promoteIfEvalValAndCheckIsLlvmVal(val, true);
+    if (valPromo.isInvalid()) return false;
+
+    llvm::StoreInst *llvmStore = llvmBuilder.CreateStore(valPromo.getLlvmVal().val, ptrPromo.getLlvmVal().val);
+    llvmStore->setAtomic(makeLlvmAtomicOrdering(attrs.ordering));
+
+    return true;
+}
+
+NodeVal Compiler::performAtomicRmw(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicOp op, TypeTable::Id resTy, AtomicAttrs attrs) {
+    if (!checkInLocalScope(codeLoc, true)) return NodeVal();
+
+    NodeVal ptrPromo = promoteIfEvalValAndCheckIsLlvmVal(ptr, true);
+    if (ptrPromo.isInvalid()) return NodeVal();
+
+    NodeVal valPromo = promoteIfEvalValAndCheckIsLlvmVal(val, true);
+    if (valPromo.isInvalid()) return NodeVal();
+
+    bool isTypeI = typeTable->worksAsTypeI(resTy);
+
+    llvm::AtomicRMWInst::BinOp llvmOp;
+    switch (op) {
+    case AtomicOp::XCHG:
+        llvmOp = llvm::AtomicRMWInst::Xchg;
+        break;
+    case AtomicOp::ADD:
+        llvmOp = llvm::AtomicRMWInst::Add;
+        break;
+    case AtomicOp::SUB:
+        llvmOp = llvm::AtomicRMWInst::Sub;
+        break;
+    case AtomicOp::AND:
+        llvmOp = llvm::AtomicRMWInst::And;
+        break;
+    case AtomicOp::OR:
+        llvmOp = llvm::AtomicRMWInst::Or;
+        break;
+    case AtomicOp::XOR:
+        llvmOp = llvm::AtomicRMWInst::Xor;
+        break;
+    case AtomicOp::MIN:
+        llvmOp = isTypeI ? llvm::AtomicRMWInst::Min : llvm::AtomicRMWInst::UMin;
+        break;
+    case AtomicOp::MAX:
+        llvmOp = isTypeI ? llvm::AtomicRMWInst::Max : llvm::AtomicRMWInst::UMax;
+        break;
+    default:
+        msgs->errorInternal(codeLoc);
+        return NodeVal();
+    }
+
+    LlvmVal llvmVal(resTy);
+    llvmVal.val = llvmBuilder.CreateAtomicRMW(llvmOp, ptrPromo.getLlvmVal().val, valPromo.getLlvmVal().val, makeLlvmAtomicOrdering(attrs.ordering));
+    return NodeVal(codeLoc, llvmVal);
+}
+
+NodeVal Compiler::performAtomicCmpXchg(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &expected, const NodeVal &desired, TypeTable::Id resTy, AtomicAttrs attrs) {
+    if (!checkInLocalScope(codeLoc, true)) return NodeVal();
+
+    NodeVal ptrPromo = promoteIfEvalValAndCheckIsLlvmVal(ptr, true);
+    if (ptrPromo.isInvalid()) return NodeVal();
+
+    NodeVal expectedPromo = promoteIfEvalValAndCheckIsLlvmVal(expected, true);
+    if (expectedPromo.isInvalid()) return NodeVal();
+
+    NodeVal desiredPromo = promoteIfEvalValAndCheckIsLlvmVal(desired, true);
+    if (desiredPromo.isInvalid()) return NodeVal();
+
+    // failure only loads, so it can't release
+    llvm::AtomicOrdering llvmOrdering = makeLlvmAtomicOrdering(attrs.ordering);
+    llvm::AtomicOrdering llvmOrderingFail = llvm::AtomicCmpXchgInst::getStrongestFailureOrdering(llvmOrdering);
+
+    llvm::AtomicCmpXchgInst *llvmCmpXchg = llvmBuilder.CreateAtomicCmpXchg(
+        ptrPromo.getLlvmVal().val, expectedPromo.getLlvmVal().val, desiredPromo.getLlvmVal().val,
+        llvmOrdering, llvmOrderingFail);
+    llvmCmpXchg->setWeak(attrs.weak);
+
+    // tuple of the two is laid out the same as the result of cmpxchg
+    LlvmVal llvmVal(resTy);
+    llvmVal.val = llvmCmpXchg;
+    return NodeVal(codeLoc, llvmVal);
+}
+
+bool Compiler::performFence(CodeLoc codeLoc, AtomicAttrs attrs) {
+    if (!checkInLocalScope(codeLoc, true)) return false;
+
+    llvmBuilder.CreateFence(makeLlvmAtomicOrdering(attrs.ordering));
+
+    return true;
+}
+
+bool Compiler::doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, optional<NamePool::Id> blockName, llvm::BasicBlock *llvmBlock, optional<bool> likely, llvm::MDNode *llvmLoopMd) {
     if (!checkInLocalScope(codeLoc, true)) return false;
 
     NodeVal condPromo = promoteIfEvalValAndCheckIsLlvmVal(cond, true);
@@ -844,14 +1103,24 @@ bool Compiler::doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, optional<Na
     llvm::BasicBlock *llvmBlockDrops = llvm::BasicBlock::Create(llvmContext, "drops");
     llvm::BasicBlock *llvmBlockAfter = llvm::BasicBlock::Create(llvmContext, "after");
 
-    llvmBuilder.CreateCondBr(condPromo.getLlvmVal().val, llvmBlockDrops, llvmBlockAfter);
+    llvm::BranchInst *llvmCondBr = llvmBuilder.CreateCondBr(condPromo.getLlvmVal().val, llvmBlockDrops, llvmBlockAfter);
+    // if there are no drops, this will become the back-edge once empty llvm blocks are folded
+    if (llvmLoopMd != nullptr) llvmCondBr->setMetadata(llvm::LLVMContext::MD_loop, llvmLoopMd);
+    if (likely.has_value()) {
+        // same weights that llvm.expect would give
+        llvm::MDNode *llvmWeights = likely.value() ?
+            llvm::MDBuilder(llvmContext).createBranchWeights(2000, 1) :
+            llvm::MDBuilder(llvmContext).createBranchWeights(1, 2000);
+        llvmCondBr->setMetadata(llvm::LLVMContext::MD_prof, llvmWeights);
+    }
 
     getLlvmCurrFunction()->getBasicBlockList().push_back(llvmBlockDrops);
     llvmBuilder.SetInsertPoint(llvmBlockDrops);
 
     if (!callDropFuncsFromBlockToCurrBlock(codeLoc, blockName)) return false;
 
-    llvmBuilder.CreateBr(llvmBlock);
+    llvm::BranchInst *llvmBr = llvmBuilder.CreateBr(llvmBlock);
+    if (llvmLoopMd != nullptr) llvmBr->setMetadata(llvm::LLVMContext::MD_loop, llvmLoopMd);
 
     getLlvmCurrFunction()->getBasicBlockList().push_back(llvmBlockAfter);
     llvmBuilder.SetInsertPoint(llvmBlockAfter);
@@ -894,6 +1163,16 @@ NodeVal Compiler::promoteEvalVal(CodeLoc codeLoc, const EvalVal &eval) {
         }
 
         llvmConst = llvm::ConstantArray::get(llvmArrayType, llvmConsts);
+    } else if (EvalVal::isVec(eval, typeTable)) {
+        vector<llvm::Constant*> llvmConsts;
+        llvmConsts.reserve(eval.elems().size());
+        for (const NodeVal &elem : eval.elems()) {
+            NodeVal elemPromo = promoteEvalVal(codeLoc, elem.getEvalVal());
+            if (elemPromo.isInvalid()) return NodeVal();
+            llvmConsts.push_back((llvm::Constant*) elemPromo.getLlvmVal().val);
+        }
+
+        llvmConst = llvm::ConstantVector::get(llvmConsts);
     } else if (EvalVal::isTuple(eval, typeTable)) {
         vector<llvm::Constant*> llvmConsts;
         llvmConsts.reserve(eval.elems().size());
@@ -916,6 +1195,11 @@ NodeVal Compiler::promoteEvalVal(CodeLoc codeLoc, const EvalVal &eval) {
             llvmConsts.push_back((llvm::Constant*) elemPromo.getLlvmVal().val);
         }
 
+        // tail padding of over-aligned data
+        if (llvmStructType->getNumElements() > llvmConsts.size()) {
+            llvmConsts.push_back(llvm::Constant::getNullValue(llvmStructType->getElementType(llvmConsts.size())));
+        }
+
         llvmConst = llvm::ConstantStruct::get(llvmStructType, llvmConsts);
     } else if (EvalVal::isFunc(eval, typeTable)) {
         optional<FuncId> funcId = EvalVal::getValueFunc(eval, typeTable).value();
@@ -953,6 +1237,26 @@ NodeVal Compiler::promoteIfEvalValAndCheckIsLlvmVal(const NodeVal &node, bool or
     return promo;
 }
 
+optional<uint64_t> Compiler::getAlignmentFor(TypeTable::Id ty, optional<uint64_t> align) const {
+    optional<uint64_t> tyAlign;
+    if (typeTable->isExplicitType(ty)) {
+        tyAlign = getAlignmentFor(typeTable->getExplicitType(ty).type);
+    } else if (typeTable->isTypeDescr(ty)) {
+        // arrays of over-aligned data are over-aligned themselves
+        const TypeTable::TypeDescr &descr = typeTable->getTypeDescr(ty);
+        bool allArrs = all_of(descr.decors.begin(), descr.decors.end(), [](const TypeTable::TypeDescr::Decor &decor) {
+            return decor.type == TypeTable::TypeDescr::Decor::D_ARR;
+        });
+        if (allArrs) tyAlign = getAlignmentFor(descr.base);
+    } else if (typeTable->isDataType(ty)) {
+        tyAlign = typeTable->getDataType(ty).align;
+    }
+
+    if (!tyAlign.has_value()) return align;
+    if (!align.has_value()) return tyAlign;
+    return max(align.value(), tyAlign.value());
+}
+
 string Compiler::getNameForLlvm(NamePool::Id name) const {
     // LLVM is smart enough to put quotes around IDs with special chars, but let's keep this method in anyway.
     return namePool->get(name);
@@ -972,6 +1276,17 @@ bool Compiler::isLlvmBlockTerminated() const {
     return !llvmBuilder.GetInsertBlock()->empty() && llvmBuilder.GetInsertBlock()->back().isTerminator();
 }
 
+void Compiler::removeUnusedAggregateLoads(llvm::Function *llvmFunc) {
+    for (llvm::BasicBlock &llvmBlock : *llvmFunc) {
+        for (auto it = llvmBlock.begin(); it != llvmBlock.end();) {
+            llvm::LoadInst *llvmLoad = llvm::dyn_cast<llvm::LoadInst>(&*it++);
+            if (llvmLoad == nullptr || llvmLoad->isVolatile() || !llvmLoad->use_empty()) continue;
+
+            if (llvmLoad->getType()->isAggregateType()) llvmLoad->eraseFromParent();
+        }
+    }
+}
+
 llvm::Constant* Compiler::getLlvmConstB(bool val) {
     if (val) return llvm::ConstantInt::getTrue(llvmContext);
     else return llvm::ConstantInt::getFalse(llvmContext);
@@ -1024,6 +1339,9 @@ llvm::Type* Compiler::makeLlvmType(TypeTable::Id typeId) {
             case TypeTable::TypeDescr::Decor::D_ARR:
                 llvmType = llvm::ArrayType::get(llvmType, decor.len);
                 break;
+            case TypeTable::TypeDescr::Decor::D_VEC:
+                llvmType = llvm::FixedVectorType::get(llvmType, decor.len);
+                break;
             default:
                 return nullptr;
             }
@@ -1062,7 +1380,20 @@ llvm::Type* Compiler::makeLlvmType(TypeTable::Id typeId) {
                 if (elementType == nullptr) return nullptr;
                 elementTypes[i] = elementType;
             }
-            ((llvm::StructType*) llvmType)->setBody(elementTypes);
+            ((llvm::StructType*) llvmType)->setBody(elementTypes, data.packed);
+
+            // over-aligned data gets tail padding, so that its size is a multiple of its alignment
+            if (data.align.has_value()) {
+                if (!initLlvmTargetMachine()) return nullptr;
+
+                // a fresh data layout, as the module's one caches struct layouts
+                uint64_t size = targetMachine->createDataLayout().getTypeAllocSize(llvmType).getFixedSize();
+                uint64_t sizeAligned = llvm::alignTo(size, data.align.value());
+                if (sizeAligned > size) {
+                    elementTypes.push_back(llvm::ArrayType::get(llvm::Type::getInt8Ty(llvmContext), sizeAligned-size));
+                    ((llvm::StructType*) llvmType)->setBody(elementTypes, data.packed);
+                }
+            }
         }
     } else if (typeTable->isCallable(typeId)) {
         llvmType = makeLlvmFunctionType(typeId);
@@ -1118,6 +1449,10 @@ llvm::Constant* Compiler::makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeI
             llvm::Constant *elemLlvmZero = elem.noZeroInit ? llvm::UndefValue::get(elemLlvmType) : makeLlvmZero(elemLlvmType, elem.type);
             elemVals.push_back(elemLlvmZero);
         }
+        // tail padding of over-aligned data
+        if (((llvm::StructType*) llvmType)->getNumElements() > elemVals.size()) {
+            elemVals.push_back(llvm::Constant::getNullValue(((llvm::StructType*) llvmType)->getElementType(elemVals.size())));
+        }
 
         llvmZero = llvm::ConstantStruct::get((llvm::StructType*) llvmType, elemVals);
     } else {
@@ -1127,20 +1462,35 @@ llvm::Constant* Compiler::makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeI
     return llvmZero;
 }
 
-llvm::GlobalValue* Compiler::makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name) {
+llvm::GlobalValue* Compiler::makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name, optional<uint64_t> align, bool threadLocal) {
     if (init == nullptr) init = llvm::Constant::getNullValue(type);
 
-    return new llvm::GlobalVariable(
+    llvm::GlobalVariable *llvmGlobal = new llvm::GlobalVariable(
         *llvmModule,
         type,
         isConstant,
         llvm::GlobalValue::PrivateLinkage,
         init,
         name);
+
+    // an explicit alignment on a global is taken as is, so it must not go below the preferred one
+    if (align.has_value() && initLlvmTargetMachine()) {
+        llvm::Align llvmAlign = targetMachine->createDataLayout().getPrefTypeAlign(type);
+        llvmGlobal->setAlignment(max(llvmAlign, llvm::Align(align.value())));
+    }
+
+    // the backend narrows this down to a faster model when it can
+    if (threadLocal) llvmGlobal->setThreadLocalMode(llvm::GlobalValue::GeneralDynamicTLSModel);
+
+    return llvmGlobal;
 }
 
-llvm::AllocaInst* Compiler::makeLlvmAlloca(llvm::Type *type, const std::string &name) {
-    return llvmBuilderAlloca.CreateAlloca(type, nullptr, name);
+llvm::AllocaInst* Compiler::makeLlvmAlloca(llvm::Type *type, const std::string &name, optional<uint64_t> align) {
+    llvm::AllocaInst *llvmAlloca = llvmBuilderAlloca.CreateAlloca(type, nullptr, name);
+    if (align.has_value() && align.value() > llvmAlloca->getAlign().value()) {
+        llvmAlloca->setAlignment(llvm::Align(align.value()));
+    }
+    return llvmAlloca;
 }
 
 llvm::Value* Compiler::makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId) {
@@ -1156,7 +1506,23 @@ llvm::Value* Compiler::makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTy
 
     llvm::Value *dstLlvmVal = nullptr;
 
-    if (typeTable->worksAsTypeI(srcTypeId)) {
+    if (typeTable->worksAsTypeVec(dstTypeId)) {
+        size_t len = typeTable->extractLenOfVec(dstTypeId).value();
+        TypeTable::Id dstElemTypeId = typeTable->addTypeIndexOf(dstTypeId).value();
+
+        if (typeTable->worksAsTypeVec(srcTypeId)) {
+            if (typeTable->extractLenOfVec(srcTypeId).value() != len) return nullptr;
+
+            // llvm's casts work lane by lane on vectors
+            TypeTable::Id srcElemTypeId = typeTable->addTypeIndexOf(srcTypeId).value();
+            dstLlvmVal = makeLlvmCast(srcLlvmVal, srcElemTypeId, dstLlvmType, dstElemTypeId);
+        } else if (typeTable->worksAsPrimitive(srcTypeId)) {
+            llvm::Value *dstLlvmElemVal = makeLlvmCast(srcLlvmVal, srcTypeId, dstElemTypeId);
+            if (dstLlvmElemVal == nullptr) return nullptr;
+
+            dstLlvmVal = llvmBuilder.CreateVectorSplat(len, dstLlvmElemVal, "splat_tmp");
+        }
+    } else if (typeTable->worksAsTypeI(srcTypeId)) {
         if (typeTable->worksAsTypeI(dstTypeId)) {
             dstLlvmVal = llvmBuilder.CreateIntCast(srcLlvmVal, dstLlvmType, true, "i2i_cast");
         } else if (typeTable->worksAsTypeU(dstTypeId)) {
@@ -1269,14 +1635,234 @@ llvm::Value* Compiler::makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTy
     return dstLlvmVal;
 }
 
+llvm::MDNode* Compiler::makeLlvmLoopMd(const SymbolTable::LoopHints &hints, llvm::MDNode *llvmAccessGroup) {
+    auto makeFlag = [&](const string &name) -> llvm::Metadata* {
+        return llvm::MDNode::get(llvmContext, {llvm::MDString::get(llvmContext, name)});
+    };
+    auto makeCount = [&](const string &name, uint64_t count) -> llvm::Metadata* {
+        llvm::Constant *llvmCount = llvm::ConstantInt::get(llvm::Type::getInt32Ty(llvmContext), count);
+        return llvm::MDNode::get(llvmContext, {llvm::MDString::get(llvmContext, name), llvm::ConstantAsMetadata::get(llvmCount)});
+    };
+
+    // first operand is a self-reference, to keep the node unique
+    vector<llvm::Metadata*> llvmOps{nullptr};
+
+    if (hints.vectorize.has_value()) {
+        if (hints.vectorize.value()) {
+            llvmOps.push_back(llvm::MDNode::get(llvmContext, {
+                llvm::MDString::get(llvmContext, "llvm.loop.vectorize.enable"),
+                llvm::ConstantAsMetadata::get(getLlvmConstB(true))}));
+            if (hints.vectorizeWidth.has_value()) llvmOps.push_back(makeCount("llvm.loop.vectorize.width", hints.vectorizeWidth.value()));
+        } else {
+            llvmOps.push_back(makeCount("llvm.loop.vectorize.width", 1));
+        }
+    }
+    if (hints.interleave.has_value()) {
+        llvmOps.push_back(makeCount("llvm.loop.interleave.count", hints.interleave.value() ? hints.interleaveCount.value_or(0) : 1));
+    }
+    if (hints.unroll.has_value()) {
+        if (!hints.unroll.value()) llvmOps.push_back(makeFlag("llvm.loop.unroll.disable"));
+        else if (hints.unrollCount.has_value()) llvmOps.push_back(makeCount("llvm.loop.unroll.count", hints.unrollCount.value()));
+        else llvmOps.push_back(makeFlag("llvm.loop.unroll.enable"));
+    }
+    if (llvmAccessGroup != nullptr) {
+        llvmOps.push_back(llvm::MDNode::get(llvmContext, {llvm::MDString::get(llvmContext, "llvm.loop.parallel_accesses"), llvmAccessGroup}));
+    }
+
+    llvm::MDNode *llvmLoopMd = llvm::MDNode::getDistinct(llvmContext, llvmOps);
+    llvmLoopMd->replaceOperandWith(0, llvmLoopMd);
+    return llvmLoopMd;
+}
+
+llvm::AtomicOrdering Compiler::makeLlvmAtomicOrdering(AtomicOrdering ordering) {
+    switch (ordering) {
+    case AtomicOrdering::RELAXED:
+        return llvm::AtomicOrdering::Monotonic;
+    case AtomicOrdering::ACQUIRE:
+        return llvm::AtomicOrdering::Acquire;
+    case AtomicOrdering::RELEASE:
+        return llvm::AtomicOrdering::Release;
+    case AtomicOrdering::ACQ_REL:
+        return llvm::AtomicOrdering::AcquireRelease;
+    default:
+        return llvm::AtomicOrdering::SequentiallyConsistent;
+    }
+}
+
+llvm::Value* Compiler::makeLlvmComparison(llvm::Value *lhsLlvmVal, llvm::Value *rhsLlvmVal, TypeTable::Id ty, Oper op) {
+    bool isTypeI = typeTable->worksAsTypeI(ty);
+    bool isTypeU = typeTable->worksAsTypeU(ty);
+    bool isTypeC = typeTable->worksAsTypeC(ty);
+    bool isTypeF = typeTable->worksAsTypeF(ty);
+    bool isTypeAnyP = typeTable->worksAsTypeAnyP(ty);
+    bool isTypeB = typeTable->worksAsTypeB(ty);
+    bool isTypeCall = typeTable->worksAsCallable(ty);
+
+    llvm::Value *llvmValueRes = nullptr;
+
+    switch (op) {
+    case Oper::EQ:
+        if (isTypeI || isTypeU || isTypeC || isTypeB) {
+            llvmValueRes = llvmBuilder.CreateICmpEQ(lhsLlvmVal, rhsLlvmVal, "cmp_eq_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpOEQ(lhsLlvmVal, rhsLlvmVal, "fcmp_eq_tmp");
+        } else if (isTypeAnyP || isTypeCall) {
+            llvmValueRes = llvmBuilder.CreateICmpEQ(
+                llvmBuilder.CreatePtrToInt(lhsLlvmVal, makeLlvmPrimType(TypeTable::WIDEST_I)),
+                llvmBuilder.CreatePtrToInt(rhsLlvmVal, makeLlvmPrimType(TypeTable::WIDEST_I)),
+                "pcmp_eq_tmp");
+        }
+        break;
+    case Oper::NE:
+        if (isTypeI || isTypeU || isTypeC || isTypeB) {
+            llvmValueRes = llvmBuilder.CreateICmpNE(lhsLlvmVal, rhsLlvmVal, "cmp_ne_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpONE(lhsLlvmVal, rhsLlvmVal, "fcmp_ne_tmp");
+        } else if (isTypeAnyP || isTypeCall) {
+            llvmValueRes = llvmBuilder.CreateICmpNE(
+                llvmBuilder.CreatePtrToInt(lhsLlvmVal, makeLlvmPrimType(TypeTable::WIDEST_I)),
+                llvmBuilder.CreatePtrToInt(rhsLlvmVal, makeLlvmPrimType(TypeTable::WIDEST_I)),
+                "pcmp_ne_tmp");
+        }
+        break;
+    case Oper::LT:
+        if (isTypeI) {
+            llvmValueRes = llvmBuilder.CreateICmpSLT(lhsLlvmVal, rhsLlvmVal, "scmp_lt_tmp");
+        } else if (isTypeU || isTypeC) {
+            llvmValueRes = llvmBuilder.CreateICmpULT(lhsLlvmVal, rhsLlvmVal, "ucmp_lt_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpOLT(lhsLlvmVal, rhsLlvmVal, "fcmp_lt_tmp");
+        }
+        break;
+    case Oper::LE:
+        if (isTypeI) {
+            llvmValueRes = llvmBuilder.CreateICmpSLE(lhsLlvmVal, rhsLlvmVal, "scmp_le_tmp");
+        } else if (isTypeU || isTypeC) {
+            llvmValueRes = llvmBuilder.CreateICmpULE(lhsLlvmVal, rhsLlvmVal, "ucmp_le_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpOLE(lhsLlvmVal, rhsLlvmVal, "fcmp_le_tmp");
+        }
+        break;
+    case Oper::GT:
+        if (isTypeI) {
+            llvmValueRes = llvmBuilder.CreateICmpSGT(lhsLlvmVal, rhsLlvmVal, "scmp_gt_tmp");
+        } else if (isTypeU || isTypeC) {
+            llvmValueRes = llvmBuilder.CreateICmpUGT(lhsLlvmVal, rhsLlvmVal, "ucmp_gt_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpOGT(lhsLlvmVal, rhsLlvmVal, "fcmp_gt_tmp");
+        }
+        break;
+    case Oper::GE:
+        if (isTypeI) {
+            llvmValueRes = llvmBuilder.CreateICmpSGE(lhsLlvmVal, rhsLlvmVal, "scmp_ge_tmp");
+        } else if (isTypeU || isTypeC) {
+            llvmValueRes = llvmBuilder.CreateICmpUGE(lhsLlvmVal, rhsLlvmVal, "ucmp_ge_tmp");
+        } else if (isTypeF) {
+            llvmValueRes = llvmBuilder.CreateFCmpOGE(lhsLlvmVal, rhsLlvmVal, "fcmp_ge_tmp");
+        }
+        break;
+    default:
+        break;
+    }
+
+    return llvmValueRes;
+}
+
+void Compiler::finalizeModule() {
+    // private functions nobody references would get stripped anyway, don't waste time optimizing them
+    // erasing one may leave others without references, so repeat until nothing changes
+    bool erased = true;
+    while (erased) {
+        erased = false;
+        for (auto it = llvmModule->begin(); it != llvmModule->end();) {
+            llvm::Function &llvmFunc = *it++;
+            if (!llvmFunc.hasPrivateLinkage()) continue;
+
+            llvmFunc.removeDeadConstantUsers();
+            if (llvmFunc.use_empty()) {
+                llvmFunc.eraseFromParent();
+                erased = true;
+            }
+        }
+    }
+
+    for (llvm::Function &llvmFunc : *llvmModule) {
+        if (!llvmFunc.isDeclaration()) llvmFpm->run(llvmFunc);
+    }
+
+    llvm::legacy::PassManager llvmPm;
+    // vectorizers need to know the target to make decisions
+    llvmPm.add(llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+    llvmPmb->populateModulePassManager(llvmPm);
+    llvmPm.run(*llvmModule);
+}
+
+namespace {
+// hashes whatever is written into it, so that the module text is never held in memory whole
+class Md5Ostream : public llvm::raw_ostream {
+    llvm::MD5 &md5;
+    std::uint64_t pos = 0;
+
+    void write_impl(const char *ptr, size_t size) override {
+        md5.update(llvm::StringRef(ptr, size));
+        pos += size;
+    }
+
+    std::uint64_t current_pos() const override { return pos; }
+
+public:
+    explicit Md5Ostream(llvm::MD5 &md5) : md5(md5) {}
+
+    ~Md5Ostream() override { flush(); }
+};
+}
+
+std::string Compiler::makeModuleFingerprint() const {
+    llvm::MD5 md5;
+    {
+        Md5Ostream ss(md5);
+        ss << OrbCompiler_VERSION_MAJOR << "." << OrbCompiler_VERSION_MINOR << ";"
+            << llvmModule->getTargetTriple() << ";" << llvmPmb->OptLevel << ";";
+        llvmModule->print(ss, nullptr);
+    }
+
+    llvm::MD5::MD5Result md5Result;
+    md5.final(md5Result);
+    return md5Result.digest().str().str();
+}
+
+std::string Compiler::makeCachedObjectFilename() const {
+    filesystem::path path = filesystem::path(cacheDir.value()) / makeModuleFingerprint();
+    path += PLATFORM_WINDOWS ? ".obj" : ".o";
+    return path.string();
+}
+
+// failing to store in cache does not fail the compilation
+void Compiler::storeInCache(const std::string &filename, const std::string &cachedFilename) const {
+    std::error_code errorCode;
+    filesystem::create_directories(cacheDir.value(), errorCode);
+    if (errorCode) return;
+
+    // copy under a unique name first, so that concurrent runs never see a partially written file
+    llvm::SmallString<128> tempFilename;
+    errorCode = llvm::sys::fs::createUniqueFile(llvm::Twine(cacheDir.value()) + "/orbc-%%%%%%%%.tmp", tempFilename);
+    if (errorCode) return;
+
+    filesystem::copy_file(filename, tempFilename.str().str(), filesystem::copy_options::overwrite_existing, errorCode);
+    if (!errorCode) errorCode = llvm::sys::fs::rename(tempFilename, cachedFilename);
+    if (errorCode) llvm::sys::fs::remove(tempFilename);
+}
+
 bool Compiler::initLlvmTargetMachine() {
     if (targetMachine != nullptr) return true;
 
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmParsers();
-    llvm::InitializeAllAsmPrinters();
+    // code is only ever generated for the host, no need to initialize other targets
+    if (llvm::InitializeNativeTarget() ||
+        llvm::InitializeNativeTargetAsmParser() ||
+        llvm::InitializeNativeTargetAsmPrinter()) {
+        llvm::errs() << "Could not initialize the native target.";
+        return false;
+    }
 
     std::string targetTriple = llvm::sys::getDefaultTargetTriple();
     llvmModule->setTargetTriple(targetTriple);
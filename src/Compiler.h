@@ -17,10 +17,23 @@ class Compiler : public Processor {
     std::unique_ptr<llvm::legacy::FunctionPassManager> llvmFpm;
     llvm::TargetMachine *targetMachine;
     bool link = false;
+    // objects are cached per whole module, as module passes optimize functions together
+    std::optional<std::string> cacheDir;
+    // printed from binary, between optimizing and codegen
+    std::optional<std::string> outputLlvm;
 
     bool initLlvmTargetMachine();
+    void finalizeModule();
+    void printout(const std::string &filename);
+    bool emitObjectFile(const std::string &filename);
+    // identifies the object code the module would compile into
+    std::string makeModuleFingerprint() const;
+    std::string makeCachedObjectFilename() const;
+    void storeInCache(const std::string &filename, const std::string &cachedFilename) const;
 
     bool isLlvmBlockTerminated() const;
+    // references to aggregate vars are loaded eagerly, this removes those of which only the address was used
+    void removeUnusedAggregateLoads(llvm::Function *llvmFunc);
     llvm::Function* getLlvmCurrFunction() { return llvmBuilder.GetInsertBlock()->getParent(); }
     llvm::Constant* getLlvmConstB(bool val);
     // generates a constant for a string literal
@@ -31,11 +44,18 @@ class Compiler : public Processor {
     llvm::Type* makeLlvmTypeOrError(CodeLoc codeLoc, TypeTable::Id typeId);
     llvm::Constant* makeLlvmZero(TypeTable::Id typeId);
     llvm::Constant* makeLlvmZero(llvm::Type *llvmType, TypeTable::Id typeId);
-    llvm::GlobalValue* makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name);
-    llvm::AllocaInst* makeLlvmAlloca(llvm::Type *type, const std::string &name);
+    // align, if given, can only raise the alignment the type would have by default
+    llvm::GlobalValue* makeLlvmGlobal(llvm::Type *type, llvm::Constant *init, bool isConstant, const std::string &name, std::optional<std::uint64_t> align = std::nullopt, bool threadLocal = false);
+    llvm::AllocaInst* makeLlvmAlloca(llvm::Type *type, const std::string &name, std::optional<std::uint64_t> align = std::nullopt);
     llvm::Value* makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId);
     llvm::Value* makeLlvmCast(llvm::Value *srcLlvmVal, TypeTable::Id srcTypeId, llvm::Type *dstLlvmType, TypeTable::Id dstTypeId);
+    llvm::MDNode* makeLlvmLoopMd(const SymbolTable::LoopHints &hints, llvm::MDNode *llvmAccessGroup);
+    llvm::AtomicOrdering makeLlvmAtomicOrdering(AtomicOrdering ordering);
+    // ty is the type of operands, or of their lanes if they are vectors
+    llvm::Value* makeLlvmComparison(llvm::Value *lhsLlvmVal, llvm::Value *rhsLlvmVal, TypeTable::Id ty, Oper op);
 
+    // alignment requested for values of the type through data::align, combined with align if given
+    std::optional<std::uint64_t> getAlignmentFor(TypeTable::Id ty, std::optional<std::uint64_t> align = std::nullopt) const;
     std::string getNameForLlvm(NamePool::Id name) const;
     // handles name mangling
     std::optional<std::string> getFuncNameForLlvm(const FuncValue &func);
@@ -44,21 +64,23 @@ class Compiler : public Processor {
     NodeVal promoteEvalVal(const NodeVal &node);
     NodeVal promoteIfEvalValAndCheckIsLlvmVal(const NodeVal &node, bool orError);
 
-    bool doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, std::optional<NamePool::Id> blockName, llvm::BasicBlock *llvmBlock);
+    // llvmLoopMd, if given, is attached to the jump, marking it as a loop back-edge
+    bool doCondBlockJump(CodeLoc codeLoc, const NodeVal &cond, std::optional<NamePool::Id> blockName, llvm::BasicBlock *llvmBlock, std::optional<bool> likely, llvm::MDNode *llvmLoopMd = nullptr);
 
     NodeVal performLoad(CodeLoc codeLoc, VarId varId) override;
     NodeVal performLoad(CodeLoc codeLoc, FuncId funcId) override;
     NodeVal performLoad(CodeLoc codeLoc, MacroId macroId) override;
     NodeVal performZero(CodeLoc codeLoc, TypeTable::Id ty) override;
-    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) override;
-    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) override;
+    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty, SymAttrs attrs) override;
+    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init, SymAttrs attrs) override;
     NodeVal performCast(CodeLoc codeLoc, const NodeVal &node, CodeLoc codeLocTy, TypeTable::Id ty) override;
     bool performBlockSetUp(CodeLoc codeLoc, SymbolTable::Block &block) override;
     std::optional<bool> performBlockBody(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &nodeBody) override;
     NodeVal performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success) override;
-    bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
-    bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
+    bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) override;
+    bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) override;
     bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) override;
+    bool performBranch(CodeLoc codeLoc, const NodeVal &val, const std::vector<std::vector<NodeVal>> &caseVals, const std::vector<const NodeVal*> &bodies) override;
     bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) override;
@@ -73,11 +95,17 @@ class Compiler : public Processor {
     ComparisonSignal performOperComparisonSetUp(CodeLoc codeLoc, std::size_t opersCnt) override;
     std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) override;
     NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) override;
+    NodeVal performOperComparisonVec(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, TypeTable::Id resTy) override;
     NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) override;
     NodeVal performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) override;
     NodeVal performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_t ind, TypeTable::Id resTy) override;
     NodeVal performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, OperRegAttrs attrs) override;
     std::optional<std::uint64_t> performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) override;
+    NodeVal performAtomicLoad(CodeLoc codeLoc, const NodeVal &ptr, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    bool performAtomicStore(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicAttrs attrs) override;
+    NodeVal performAtomicRmw(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicOp op, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    NodeVal performAtomicCmpXchg(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &expected, const NodeVal &desired, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    bool performFence(CodeLoc codeLoc, AtomicAttrs attrs) override;
 
 public:
     Compiler(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args);
@@ -90,6 +118,5 @@ public:
     llvm::Type* genPrimTypeF64();
     llvm::Type* genPrimTypePtr();
 
-    void printout(const std::string &filename) const;
     bool binary(const std::string &filename);
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "EvalVal.h"
+#include <bit>
 #include "LiteralVal.h"
 #include "NodeVal.h"
 #include "SymbolTable.h"
@@ -25,6 +26,8 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
         evalVal.value = Pointer(nullptr);
     } else if (typeTable->worksAsTypeStr(t)) {
         evalVal.value = optional<StringPool::Id>();
+    } else if (typeTable->worksAsTypeArrP(t)) {
+        evalVal.value = ArrPointer();
     } else if (typeTable->worksAsCallable(t, true)) {
         evalVal.value = optional<FuncId>();
     } else if (typeTable->worksAsCallable(t, false)) {
@@ -51,6 +54,11 @@ EvalVal EvalVal::makeVal(TypeTable::Id t, TypeTable *typeTable) {
         size_t len = typeTable->extractLenOfArr(t).value();
         TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
 
+        evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeVal(elemType, typeTable)));
+    } else if (typeTable->worksAsTypeVec(t)) {
+        size_t len = typeTable->extractLenOfVec(t).value();
+        TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
+
         evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeVal(elemType, typeTable)));
     } else {
         evalVal.value = EasyZeroVals();
@@ -71,6 +79,8 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
         evalVal.value = Pointer(nullptr);
     } else if (typeTable->worksAsTypeStr(t)) {
         evalVal.value = optional<StringPool::Id>();
+    } else if (typeTable->worksAsTypeArrP(t)) {
+        evalVal.value = ArrPointer();
     } else if (typeTable->worksAsCallable(t, true)) {
         evalVal.value = optional<FuncId>();
     } else if (typeTable->worksAsCallable(t, false)) {
@@ -97,6 +107,11 @@ EvalVal EvalVal::makeZero(TypeTable::Id t, NamePool *namePool, TypeTable *typeTa
         size_t len = typeTable->extractLenOfArr(t).value();
         TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
 
+        evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeZero(elemType, namePool, typeTable)));
+    } else if (typeTable->worksAsTypeVec(t)) {
+        size_t len = typeTable->extractLenOfVec(t).value();
+        TypeTable::Id elemType = typeTable->addTypeIndexOf(t).value();
+
         evalVal.value = vector<NodeVal>(len, NodeVal(CodeLoc(), makeZero(elemType, namePool, typeTable)));
     } else {
         evalVal.value = EasyZeroVals();
@@ -170,6 +185,10 @@ bool EvalVal::isNonNullStr(const EvalVal &val, const TypeTable *typeTable) {
     return isStr(val, typeTable) && val.str().has_value();
 }
 
+bool EvalVal::isArrP(const EvalVal &val, const TypeTable *typeTable) {
+    return typeTable->worksAsTypeArrP(val.type) && !typeTable->worksAsTypeStr(val.type);
+}
+
 bool EvalVal::isAnyP(const EvalVal &val, const TypeTable *typeTable) {
     return typeTable->worksAsTypeAnyP(val.type);
 }
@@ -178,6 +197,10 @@ bool EvalVal::isArr(const EvalVal &val, const TypeTable *typeTable) {
     return typeTable->worksAsTypeArr(val.type);
 }
 
+bool EvalVal::isVec(const EvalVal &val, const TypeTable *typeTable) {
+    return typeTable->worksAsTypeVec(val.type);
+}
+
 bool EvalVal::isTuple(const EvalVal &val, const TypeTable *typeTable) {
     return typeTable->worksAsTuple(val.type);
 }
@@ -196,6 +219,7 @@ bool EvalVal::isZero(const EvalVal &val, const TypeTable *typeTable) {
 bool EvalVal::isNull(const EvalVal &val, const TypeTable *typeTable) {
     if (isP(val, typeTable)) return isNull(val.p());
     if (isStr(val, typeTable)) return !val.str().has_value();
+    if (isArrP(val, typeTable)) return val.arrP().elems == nullptr;
     return isAnyP(val, typeTable);
 }
 
@@ -205,14 +229,16 @@ bool EvalVal::isCallableNoValue(const EvalVal &val, const TypeTable *typeTable)
 }
 
 bool EvalVal::isNull(const Pointer &ptr) {
-    return holds_alternative<NodeVal*>(ptr) && get<NodeVal*>(ptr) == nullptr;
+    return holds_alternative<ElemPointer>(ptr) && get<ElemPointer>(ptr).elem == nullptr;
 }
 
 NodeVal& EvalVal::deref(const Pointer &ptr, SymbolTable *symbolTable) {
     if (holds_alternative<VarId>(ptr)) {
         return symbolTable->getVar(get<VarId>(ptr)).var;
+    } else if (holds_alternative<ArrPointer>(ptr)) {
+        return *getArrPointee(get<ArrPointer>(ptr), 0);
     } else {
-        return *get<NodeVal*>(ptr);
+        return *get<ElemPointer>(ptr).elem;
     }
 }
 
@@ -224,6 +250,18 @@ NodeVal& EvalVal::getRefee(const EvalVal &val, SymbolTable *symbolTable) {
     return deref(val.ref, symbolTable);
 }
 
+EvalVal::ArrPointer EvalVal::makeArrPointer(NodeVal &arr, LifetimeInfo::NestLevel owner) {
+    vector<NodeVal> &elems = arr.getEvalVal().elems();
+    if (elems.empty()) return ArrPointer();
+    return ArrPointer{elems.data(), 0, (uint32_t) elems.size(), owner};
+}
+
+NodeVal* EvalVal::getArrPointee(const ArrPointer &ptr, int64_t ind) {
+    int64_t pos = (int64_t) ptr.index+ind;
+    if (pos < 0 || pos >= (int64_t) ptr.len) return nullptr;
+    return &ptr.elems[pos];
+}
+
 optional<int64_t> EvalVal::getValueI(const EvalVal &val, const TypeTable *typeTable) {
     if (typeTable->worksAsPrimitive(val.type, TypeTable::P_I8)) return val.i8();
     if (typeTable->worksAsPrimitive(val.type, TypeTable::P_I16)) return val.i16();
@@ -304,4 +342,75 @@ bool EvalVal::isImplicitCastable(const EvalVal &val, TypeTable::Id t, const Stri
     }
 
     return false;
+}
+
+optional<size_t> EvalVal::hashStructurally(const EvalVal &val, const TypeTable *typeTable) {
+    size_t hash = leNiceHasheFunctione(TypeTable::Id::Hasher()(val.type), val.escapeScore);
+
+    if (holds_alternative<EasyZeroVals>(val.value)) {
+        // reading only through the type, since the union may hold leftover bytes
+        if (isI(val, typeTable)) return leNiceHasheFunctione(hash, getValueI(val, typeTable).value());
+        if (isU(val, typeTable)) return leNiceHasheFunctione(hash, getValueU(val, typeTable).value());
+        if (isF(val, typeTable)) return leNiceHasheFunctione(hash, bit_cast<uint64_t>(getValueF(val, typeTable).value()));
+        if (isC(val, typeTable)) return leNiceHasheFunctione(hash, val.c8());
+        if (isB(val, typeTable)) return leNiceHasheFunctione(hash, val.b());
+        return hash;
+    } else if (holds_alternative<NamePool::Id>(val.value)) {
+        return leNiceHasheFunctione(hash, val.id().id);
+    } else if (holds_alternative<TypeTable::Id>(val.value)) {
+        return leNiceHasheFunctione(hash, TypeTable::Id::Hasher()(val.ty()));
+    } else if (holds_alternative<Pointer>(val.value)) {
+        if (!isNull(val.p())) return nullopt;
+        return hash;
+    } else if (holds_alternative<ArrPointer>(val.value)) {
+        if (val.arrP().elems != nullptr) return nullopt;
+        return hash;
+    } else if (holds_alternative<optional<StringPool::Id>>(val.value)) {
+        if (!val.str().has_value()) return hash;
+        return leNiceHasheFunctione(hash, StringPool::Id::Hasher()(val.str().value()));
+    } else if (holds_alternative<optional<FuncId>>(val.value)) {
+        return leNiceHasheFunctione(hash, val.f().has_value());
+    } else if (holds_alternative<optional<MacroId>>(val.value)) {
+        return leNiceHasheFunctione(hash, val.m().has_value());
+    } else {
+        for (const NodeVal &elem : val.elems()) {
+            optional<size_t> elemHash = NodeVal::hashStructurally(elem, typeTable);
+            if (!elemHash.has_value()) return nullopt;
+            hash = leNiceHasheFunctione(hash, elemHash.value());
+        }
+        return hash;
+    }
+}
+
+bool EvalVal::equalStructurally(const EvalVal &l, const EvalVal &r, const TypeTable *typeTable) {
+    if (l.type != r.type || l.escapeScore != r.escapeScore || l.value.index() != r.value.index()) return false;
+
+    if (holds_alternative<EasyZeroVals>(l.value)) {
+        if (isI(l, typeTable)) return getValueI(l, typeTable) == getValueI(r, typeTable);
+        if (isU(l, typeTable)) return getValueU(l, typeTable) == getValueU(r, typeTable);
+        if (isF(l, typeTable)) return bit_cast<uint64_t>(getValueF(l, typeTable).value()) == bit_cast<uint64_t>(getValueF(r, typeTable).value());
+        if (isC(l, typeTable)) return l.c8() == r.c8();
+        if (isB(l, typeTable)) return l.b() == r.b();
+        return true;
+    } else if (holds_alternative<NamePool::Id>(l.value)) {
+        return l.id() == r.id();
+    } else if (holds_alternative<TypeTable::Id>(l.value)) {
+        return l.ty() == r.ty();
+    } else if (holds_alternative<Pointer>(l.value)) {
+        return isNull(l.p()) && isNull(r.p());
+    } else if (holds_alternative<ArrPointer>(l.value)) {
+        return l.arrP().elems == nullptr && r.arrP().elems == nullptr;
+    } else if (holds_alternative<optional<StringPool::Id>>(l.value)) {
+        return l.str() == r.str();
+    } else if (holds_alternative<optional<FuncId>>(l.value)) {
+        return l.f() == r.f();
+    } else if (holds_alternative<optional<MacroId>>(l.value)) {
+        return l.m() == r.m();
+    } else {
+        if (l.elems().size() != r.elems().size()) return false;
+        for (size_t i = 0; i < l.elems().size(); ++i) {
+            if (!NodeVal::equalStructurally(l.elems()[i], r.elems()[i], typeTable)) return false;
+        }
+        return true;
+    }
 }
\ No newline at end of file
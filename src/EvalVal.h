@@ -15,9 +15,34 @@ class SymbolTable;
 struct FuncValue;
 struct MacroValue;
 
-// TODO eval array pointers (non-null)
 struct EvalVal {
-    typedef std::variant<NodeVal*, VarId> Pointer;
+    // pointers into values record the nest level of the symbol owning them when made, so lifetime checks don't search for it
+    // local of 0 means that the pointee is not stored in a symbol
+
+    // points to a single value, null if elem is null
+    struct ElemPointer {
+        NodeVal *elem;
+        LifetimeInfo::NestLevel owner;
+
+        ElemPointer() : elem(nullptr), owner{0, 0} {}
+        ElemPointer(std::nullptr_t) : ElemPointer() {}
+        ElemPointer(NodeVal *elem, LifetimeInfo::NestLevel owner) : elem(elem), owner(owner) {}
+
+        friend bool operator==(const ElemPointer &l, const ElemPointer &r) { return l.elem == r.elem; }
+    };
+
+    // points to the element at index of an array with len elements, null if elems is null
+    // used for array pointer values and for refs and pointers to array elements
+    struct ArrPointer {
+        NodeVal *elems = nullptr;
+        std::uint32_t index = 0, len = 0;
+        LifetimeInfo::NestLevel owner = {0, 0};
+
+        friend bool operator==(const ArrPointer &l, const ArrPointer &r)
+        { return l.elems == r.elems && l.index == r.index && l.len == r.len; }
+    };
+
+    typedef std::variant<ElemPointer, VarId, ArrPointer> Pointer;
 
 private:
     struct EasyZeroVals {
@@ -50,12 +75,13 @@ private:
         NamePool::Id,
         TypeTable::Id,
         Pointer,
+        ArrPointer,
         std::optional<StringPool::Id>,
         std::optional<FuncId>,
         std::optional<MacroId>,
         std::vector<NodeVal>> value;
 
-    Pointer ref = nullptr;
+    Pointer ref;
     LifetimeInfo lifetimeInfo;
 
     EscapeScore escapeScore = 0;
@@ -110,6 +136,9 @@ public:
     Pointer& p() { return std::get<Pointer>(value); }
     const Pointer& p() const { return std::get<Pointer>(value); }
 
+    ArrPointer& arrP() { return std::get<ArrPointer>(value); }
+    const ArrPointer& arrP() const { return std::get<ArrPointer>(value); }
+
     std::optional<StringPool::Id>& str() { return std::get<std::optional<StringPool::Id>>(value); }
     const std::optional<StringPool::Id>& str() const { return std::get<std::optional<StringPool::Id>>(value); }
 
@@ -158,9 +187,12 @@ public:
     static bool isP(const EvalVal &val, const TypeTable *typeTable);
     static bool isStr(const EvalVal &val, const TypeTable *typeTable);
     static bool isNonNullStr(const EvalVal &val, const TypeTable *typeTable);
+    // array pointer that isn't a string
+    static bool isArrP(const EvalVal &val, const TypeTable *typeTable);
     // P_PTR or pointer or array pointer
     static bool isAnyP(const EvalVal &val, const TypeTable *typeTable);
     static bool isArr(const EvalVal &val, const TypeTable *typeTable);
+    static bool isVec(const EvalVal &val, const TypeTable *typeTable);
     static bool isTuple(const EvalVal &val, const TypeTable *typeTable);
     static bool isDataType(const EvalVal &val, const TypeTable *typeTable);
     static bool isZero(const EvalVal &val, const TypeTable *typeTable);
@@ -171,6 +203,9 @@ public:
     static NodeVal& deref(const Pointer &ptr, SymbolTable *symbolTable);
     static NodeVal& getPointee(const EvalVal &val, SymbolTable *symbolTable);
     static NodeVal& getRefee(const EvalVal &val, SymbolTable *symbolTable);
+    static ArrPointer makeArrPointer(NodeVal &arr, LifetimeInfo::NestLevel owner);
+    // nullptr if out of bounds
+    static NodeVal* getArrPointee(const ArrPointer &ptr, std::int64_t ind);
 
     static std::optional<std::int64_t> getValueI(const EvalVal &val, const TypeTable *typeTable);
     static std::optional<std::uint64_t> getValueU(const EvalVal &val, const TypeTable *typeTable);
@@ -179,4 +214,9 @@ public:
     static std::optional<std::optional<FuncId>> getValueFunc(const EvalVal &val, const TypeTable *typeTable);
 
     static bool isImplicitCastable(const EvalVal &val, TypeTable::Id t, const StringPool *stringPool, const TypeTable *typeTable);
+
+    // nullopt if val holds non-null pointers, as those depend on where they point to
+    static std::optional<std::size_t> hashStructurally(const EvalVal &val, const TypeTable *typeTable);
+    // only meaningful on vals that can be hashed
+    static bool equalStructurally(const EvalVal &l, const EvalVal &r, const TypeTable *typeTable);
 };
\ No newline at end of file
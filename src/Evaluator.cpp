@@ -1,15 +1,53 @@
 #include "Evaluator.h"
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iterator>
 #include <sstream>
 #include "BlockRaii.h"
 #include "exceptions.h"
 #include "utils.h"
 using namespace std;
 
-Evaluator::Evaluator(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs)
-    : Processor(namePool, stringPool, typeTable, symbolTable, msgs) {
+Evaluator::Evaluator(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args)
+    : Processor(namePool, stringPool, typeTable, symbolTable, msgs), depthLimit(args.evalDepthLimit), stepLimit(args.evalStepLimit), profiling(args.evalProfile) {
     setEvaluator(this);
 }
 
+void Evaluator::printProfile(ostream &out) const {
+    struct Row {
+        string name;
+        CodeLoc codeLoc;
+        const ProfileEntry *profile;
+    };
+
+    vector<Row> rows;
+    for (const auto &it : funcProfiles) {
+        const FuncValue &func = symbolTable->getFunc(it.first);
+        rows.push_back({"fnc " + namePool->get(func.name), func.codeLoc, &it.second});
+    }
+    for (const auto &it : macroProfiles) {
+        const MacroValue &macro = symbolTable->getMacro(it.first);
+        rows.push_back({"mac " + namePool->get(macro.name), macro.codeLoc, &it.second});
+    }
+    sort(rows.begin(), rows.end(), [](const Row &l, const Row &r) {
+        return l.profile->exclusive > r.profile->exclusive;
+    });
+
+    auto toMs = [](chrono::steady_clock::duration d) {
+        return chrono::duration<double, milli>(d).count();
+    };
+
+    out << "Evaluation profile, by exclusive time:" << endl;
+    out << setw(12) << "excl ms" << setw(12) << "incl ms" << setw(10) << "calls" << setw(12) << "nodes" << "  callable" << endl;
+    for (const Row &row : rows) {
+        out << fixed << setprecision(3);
+        out << setw(12) << toMs(row.profile->exclusive) << setw(12) << toMs(row.profile->inclusive);
+        out << setw(10) << row.profile->calls << setw(12) << row.profile->nodes;
+        out << "  " << row.name << " (" << filesystem::relative(stringPool->get(row.codeLoc.file)).string() << ':' << row.codeLoc.start.ln << ')' << endl;
+    }
+}
+
 NodeVal Evaluator::performLoad(CodeLoc codeLoc, VarId varId) {
     SymbolTable::VarEntry &ref = symbolTable->getVar(varId);
 
@@ -54,13 +92,13 @@ NodeVal Evaluator::performZero(CodeLoc codeLoc, TypeTable::Id ty) {
     return NodeVal(codeLoc, EvalVal::makeZero(ty, namePool, typeTable));
 }
 
-NodeVal Evaluator::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) {
+NodeVal Evaluator::performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty, SymAttrs attrs) {
     EvalVal evalVal = EvalVal::makeZero(ty, namePool, typeTable);
     evalVal.getLifetimeInfo().nestLevel = symbolTable->currNestLevel();
     return NodeVal(codeLoc, move(evalVal));
 }
 
-NodeVal Evaluator::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) {
+NodeVal Evaluator::performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init, SymAttrs attrs) {
     if (!checkIsEvalVal(init, true)) return NodeVal();
 
     LifetimeInfo lifetimeInfo;
@@ -90,6 +128,8 @@ optional<bool> Evaluator::performBlockBody(CodeLoc codeLoc, SymbolTable::Block b
 
         return false;
     } catch (ExceptionEvaluatorJump ex) {
+        tailCallCand = nullptr;
+
         bool forCurrBlock = !ex.isRet && (!ex.blockName.has_value() || ex.blockName == block.name);
         if (!forCurrBlock) {
             doBlockTearDown(codeLoc, block, true, true);
@@ -104,7 +144,7 @@ NodeVal Evaluator::performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block bloc
     return doBlockTearDown(codeLoc, block, success, false);
 }
 
-bool Evaluator::performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
+bool Evaluator::performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, optional<bool> likely) {
     if (!checkIsEvalVal(cond, true)) return false;
     if (!checkIsEvalBlock(codeLoc, block, true)) return false;
 
@@ -121,7 +161,7 @@ bool Evaluator::performExit(CodeLoc codeLoc, SymbolTable::Block block, const Nod
     return true;
 }
 
-bool Evaluator::performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) {
+bool Evaluator::performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, optional<bool> likely) {
     if (!checkIsEvalVal(cond, true)) return false;
     if (!checkIsEvalBlock(codeLoc, block, true)) return false;
 
@@ -152,6 +192,25 @@ bool Evaluator::performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal v
     throw ex;
 }
 
+bool Evaluator::performBranch(CodeLoc codeLoc, const NodeVal &val, const vector<vector<NodeVal>> &caseVals, const vector<const NodeVal*> &bodies) {
+    if (!checkIsEvalVal(val, true)) return false;
+
+    for (size_t i = 0; i < caseVals.size(); ++i) {
+        for (const NodeVal &caseVal : caseVals[i]) {
+            ComparisonSignal signal;
+            if (!performOperComparison(codeLoc, val, caseVal, Oper::EQ, signal).has_value()) return false;
+
+            if (signal.result) return !processBlockNonBare(bodies[i]->getCodeLoc(), SymbolTable::Block(), *bodies[i]).isInvalid();
+        }
+    }
+
+    if (bodies.size() > caseVals.size()) {
+        return !processBlockNonBare(bodies.back()->getCodeLoc(), SymbolTable::Block(), *bodies.back()).isInvalid();
+    }
+
+    return true;
+}
+
 NodeVal Evaluator::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) {
     if (!checkIsEvalVal(func, true)) return NodeVal();
     if (!func.getEvalVal().f().has_value()) {
@@ -163,110 +222,61 @@ NodeVal Evaluator::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeV
 }
 
 NodeVal Evaluator::performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) {
-    const FuncValue &func = symbolTable->getFunc(funcId);
-
-    if (!checkIsEvalFunc(codeLocFunc, func, true)) return NodeVal();
-
-    for (const NodeVal &arg : args) {
-        if (!checkIsEvalVal(arg, true)) return NodeVal();
+    optional<size_t> memoHash;
+    {
+        const FuncValue &func = symbolTable->getFunc(funcId);
+        if (func.memoize && func.isEval() && FuncValue::getRetType(func, typeTable).has_value()) {
+            memoHash = hashArgsForMemo(args);
+            if (memoHash.has_value()) {
+                auto range = func.evalMemo.equal_range(memoHash.value());
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (equalArgsForMemo(it->second.first, args)) {
+                        // still entered as a frame, so that hits show up in profiles
+                        if (!enterFrame(codeLoc, funcId)) return NodeVal();
+                        NodeVal ret = NodeVal::copyNoRef(codeLoc, it->second.second, LifetimeInfo());
+                        exitFrame();
+                        return ret;
+                    }
+                }
+            }
+        }
     }
 
-    if (!func.defined) {
-        msgs->errorFuncNoDef(codeLocFunc);
-        return NodeVal();
-    }
-    if (!func.isEvalFunc || func.evalFunc == nullptr || func.evalFunc->isInvalid()) {
-        msgs->errorInternal(codeLocFunc);
-        return NodeVal();
+    if (!enterFrame(codeLoc, funcId)) return NodeVal();
+    NodeVal ret = doCall(codeLoc, codeLocFunc, funcId, args);
+    exitFrame();
+    // tail calls are made here, after the frame of their caller has been left
+    while (!ret.isInvalid() && tailCall.has_value()) {
+        TailCall call = move(tailCall.value());
+        tailCall.reset();
+
+        if (!enterFrame(call.codeLoc, call.funcId)) return NodeVal();
+        ret = doCall(call.codeLoc, call.codeLocFunc, call.funcId, call.args);
+        exitFrame();
+        ret.setCodeLoc(codeLoc);
     }
+    tailCall.reset();
 
-    BlockRaii blockRaii(symbolTable, SymbolTable::CalleeValueInfo::make(func, typeTable));
-
-    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+    if (ret.isInvalid()) return NodeVal();
 
-    for (size_t i = 0; i < args.size(); ++i) {
-        LifetimeInfo lifetimeInfo;
-        lifetimeInfo.noDrop = callable.getArgNoDrop(i);
-        lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+    if (memoHash.has_value() && NodeVal::hashStructurally(ret, typeTable).has_value()) {
+        vector<NodeVal> argsCopy;
+        argsCopy.reserve(args.size());
+        for (const NodeVal &arg : args) argsCopy.push_back(NodeVal::copyNoRef(arg, LifetimeInfo()));
 
-        SymbolTable::VarEntry varEntry;
-        varEntry.name = func.argNames[i];
-        varEntry.var = NodeVal::copyNoRef(args[i], lifetimeInfo);
-        symbolTable->addVar(move(varEntry));
-    }
-
-    bool retIssued = false;
-    try {
-        if (!processChildNodes(*func.evalFunc)) {
-            return NodeVal();
-        }
-    } catch (ExceptionEvaluatorJump ex) {
-        if (!ex.isRet) {
-            msgs->errorInternal(codeLoc);
-            return NodeVal();
-        }
-        retIssued = true;
+        // the body may have registered new funcs, so a reference from before may be stale
+        symbolTable->getFunc(funcId).evalMemo.emplace(memoHash.value(), make_pair(move(argsCopy), ret));
     }
 
-    if (!retIssued && !callDropFuncsCurrCallable(codeLoc)) return NodeVal();
-
-    if (callable.hasRet()) {
-        if (!retVal.has_value()) {
-            msgs->errorRetNoValue(codeLoc, callable.retType.value());
-            return NodeVal();
-        }
-
-        NodeVal ret = NodeVal::moveNoRef(codeLoc, move(retVal.value()), LifetimeInfo());
-        retVal.reset();
-        return ret;
-    } else {
-        return NodeVal(codeLoc);
-    }
+    return ret;
 }
 
 NodeVal Evaluator::performInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) {
-    const MacroValue &macro = symbolTable->getMacro(macroId);
-
-    LifetimeInfo::NestLevel nestLevel = symbolTable->currNestLevel();
-
-    BlockRaii blockRaii(symbolTable, SymbolTable::CalleeValueInfo::make(macro));
-
-    for (size_t i = 0; i < args.size(); ++i) {
-        SymbolTable::VarEntry varEntry;
-        varEntry.name = macro.argNames[i];
-        varEntry.var = move(args[i]);
-
-        if (varEntry.var.getLifetimeInfo().has_value()) {
-            LifetimeInfo lifetimeInfo = varEntry.var.getLifetimeInfo().value();
-            lifetimeInfo.invokeArg = true;
-            varEntry.var.setLifetimeInfo(lifetimeInfo);
-        }
+    if (!enterFrame(codeLoc, macroId)) return NodeVal();
+    NodeVal ret = doInvoke(codeLoc, macroId, move(args));
+    exitFrame();
 
-        symbolTable->addVar(move(varEntry));
-    }
-
-    try {
-        if (!processChildNodes(*macro.body)) {
-            return NodeVal();
-        }
-    } catch (ExceptionEvaluatorJump ex) {
-        if (!ex.isRet) {
-            msgs->errorInternal(codeLoc);
-            return NodeVal();
-        }
-    }
-
-    if (!callDropFuncsCurrCallable(codeLoc)) return NodeVal();
-
-    if (!retVal.has_value()) {
-        msgs->errorMacroNoRet(codeLoc);
-        return NodeVal();
-    }
-
-    NodeVal ret = move(retVal.value());
-    retVal.reset();
-    ret.setCodeLoc(codeLoc);
-    return move(ret);
+    return ret;
 }
 
 bool Evaluator::performFunctionDeclaration(CodeLoc codeLoc, FuncValue &func) {
@@ -323,6 +333,16 @@ bool Evaluator::performRet(CodeLoc codeLoc, NodeVal node) {
 NodeVal Evaluator::performOperUnary(CodeLoc codeLoc, NodeVal oper, Oper op) {
     if (!checkIsEvalVal(oper, true)) return NodeVal();
 
+    if (op != Oper::BIT_AND && typeTable->worksAsTypeVec(oper.getType().value())) {
+        // vectors are operated on lane by lane
+        EvalVal evalVal = EvalVal::copyNoRef(oper.getEvalVal(), LifetimeInfo());
+        for (NodeVal &elem : evalVal.elems()) {
+            elem = performOperUnary(codeLoc, NodeVal::copyNoRef(oper.getCodeLoc(), elem), op);
+            if (elem.isInvalid()) return NodeVal();
+        }
+        return NodeVal(codeLoc, move(evalVal));
+    }
+
     EvalVal evalVal = EvalVal::copyNoRef(oper.getEvalVal(), LifetimeInfo());
     TypeTable::Id ty = evalVal.getType();
     bool success = false, errorGiven = false;
@@ -439,8 +459,11 @@ optional<bool> Evaluator::performOperComparison(CodeLoc codeLoc, const NodeVal &
         if (isTypeP) {
             pl = lhs.getEvalVal().p();
             pr = rhs.getEvalVal().p();
+        } else if (EvalVal::isArrP(lhs.getEvalVal(), typeTable)) {
+            pl = lhs.getEvalVal().arrP();
+            pr = rhs.getEvalVal().arrP();
         } else {
-            pl = pr = nullptr;
+            pl = pr = EvalVal::Pointer();
         }
     } else if (isTypeB) {
         bl = lhs.getEvalVal().b();
@@ -609,13 +632,39 @@ NodeVal Evaluator::performOperComparisonTearDown(CodeLoc codeLoc, bool success,
     return NodeVal(codeLoc, move(evalVal));
 }
 
+NodeVal Evaluator::performOperComparisonVec(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, TypeTable::Id resTy) {
+    if (!checkIsEvalVal(lhs, true) || !checkIsEvalVal(rhs, true)) return NodeVal();
+
+    EvalVal evalVal = EvalVal::makeVal(resTy, typeTable);
+    for (size_t i = 0; i < evalVal.elems().size(); ++i) {
+        NodeVal lhsElem = NodeVal::copyNoRef(lhs.getCodeLoc(), lhs.getEvalVal().elems()[i]);
+        NodeVal rhsElem = NodeVal::copyNoRef(rhs.getCodeLoc(), rhs.getEvalVal().elems()[i]);
+
+        ComparisonSignal signal;
+        if (!performOperComparison(codeLoc, lhsElem, rhsElem, op, signal).has_value()) return NodeVal();
+
+        evalVal.elems()[i].getEvalVal().b() = signal.result;
+    }
+
+    return NodeVal(codeLoc, move(evalVal));
+}
+
 NodeVal Evaluator::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) {
     if (!checkIsEvalVal(lhs, true) || !checkIsEvalVal(rhs, true)) return NodeVal();
 
     LifetimeInfo lhsLifetimeInfo = lhs.getEvalVal().getLifetimeInfo();
 
+    // pointers stored in outer scopes must not outlive their pointees
+    if (holdsPointer(rhs)) {
+        optional<LifetimeInfo::NestLevel> lhsNestLevel = getPointeeNestLevel(lhs.getEvalVal().getRef());
+        if (lhsNestLevel.has_value() && lhsNestLevel.value().greaterThan(symbolTable->currNestLevel()) &&
+            !checkPointeesOutlive(rhs.getCodeLoc(), rhs, lhsNestLevel.value())) {
+            return NodeVal();
+        }
+    }
+
     NodeVal &lhsRefee = EvalVal::getRefee(lhs.getEvalVal(), symbolTable);
-    lhsRefee = NodeVal::copyNoRef(lhsRefee.getCodeLoc(), rhs, lhsLifetimeInfo);
+    moveKeepingElems(lhsRefee, NodeVal::copyNoRef(lhsRefee.getCodeLoc(), rhs, lhsLifetimeInfo));
 
     NodeVal nodeVal = NodeVal::moveNoRef(lhs.getCodeLoc(), move(rhs), lhsLifetimeInfo);
     nodeVal.getEvalVal().getRef() = lhs.getEvalVal().getRef();
@@ -625,18 +674,45 @@ NodeVal Evaluator::performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, No
 NodeVal Evaluator::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) {
     if (!checkIsEvalVal(base, true) || !checkIsEvalVal(ind, true)) return NodeVal();
 
+    if (EvalVal::isArrP(base.getEvalVal(), typeTable)) {
+        const EvalVal::ArrPointer &arrP = base.getEvalVal().arrP();
+        if (arrP.elems == nullptr) {
+            msgs->errorExprIndexNull(codeLoc);
+            return NodeVal();
+        }
+
+        // array pointers may point past the start of an array, so negative indexes can be valid
+        optional<int64_t> indexI = EvalVal::getValueI(ind.getEvalVal(), typeTable);
+        optional<uint64_t> indexU = EvalVal::getValueU(ind.getEvalVal(), typeTable);
+        int64_t index = indexI.has_value() ? indexI.value() : (int64_t) min<uint64_t>(indexU.value(), INT64_MAX);
+
+        NodeVal *elem = EvalVal::getArrPointee(arrP, index);
+        if (elem == nullptr) {
+            if (indexI.has_value()) msgs->errorExprIndexOutOfBounds(ind.getCodeLoc(), indexI.value(), arrP.len-arrP.index);
+            else msgs->errorExprIndexOutOfBounds(ind.getCodeLoc(), indexU.value(), arrP.len-arrP.index);
+            return NodeVal();
+        }
+
+        NodeVal nodeVal = NodeVal::copyNoRef(codeLoc, *elem);
+        nodeVal.getEvalVal().getType() = resTy;
+        nodeVal.getEvalVal().getRef() = EvalVal::ArrPointer{arrP.elems, (uint32_t) (arrP.index+index), arrP.len, arrP.owner};
+        return nodeVal;
+    }
+
     optional<size_t> index = EvalVal::getValueNonNeg(ind.getEvalVal(), typeTable);
     if (!index.has_value()) {
         msgs->errorInternal(codeLoc);
         return NodeVal();
     }
 
-    if (typeTable->worksAsTypeArr(base.getType().value())) {
+    if (typeTable->worksAsTypeArr(base.getType().value()) || typeTable->worksAsTypeVec(base.getType().value())) {
         NodeVal nodeVal = NodeVal::copyNoRef(codeLoc, base.getEvalVal().elems()[index.value()], base.getEvalVal().getLifetimeInfo());
         nodeVal.getEvalVal().getType() = resTy;
         if (base.hasRef()) {
             NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-            nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[index.value()];
+            EvalVal::ArrPointer elemRef = EvalVal::makeArrPointer(baseRefee, getOwnerForPointersInto(base.getEvalVal().getRef()));
+            elemRef.index = (uint32_t) index.value();
+            nodeVal.getEvalVal().getRef() = elemRef;
         }
         return nodeVal;
     } else if (typeTable->worksAsTypeStr(base.getType().value())) {
@@ -655,9 +731,6 @@ NodeVal Evaluator::performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const Nod
         EvalVal evalVal = EvalVal::makeVal(resTy, typeTable);
         evalVal.c8() = str[index.value()];
         return NodeVal(codeLoc, move(evalVal));
-    } else if (typeTable->worksAsTypeArrP(base.getType().value())) {
-        msgs->errorExprIndexNull(codeLoc);
-        return NodeVal();
     } else {
         msgs->errorInternal(codeLoc);
         return NodeVal();
@@ -673,9 +746,9 @@ NodeVal Evaluator::performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_
             nodeVal.getEvalVal().getType() = resTy;
             if (base.hasRef()) {
                 NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-                nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[ind];
+                nodeVal.getEvalVal().getRef() = EvalVal::ElemPointer(&baseRefee.getEvalVal().elems()[ind], getOwnerForPointersInto(base.getEvalVal().getRef()));
             } else {
-                nodeVal.getEvalVal().getRef() = nullptr;
+                nodeVal.getEvalVal().getRef() = EvalVal::ElemPointer();
             }
         }
         if (base.isInvokeArg() && nodeVal.getLifetimeInfo().has_value()) {
@@ -689,12 +762,47 @@ NodeVal Evaluator::performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_
         nodeVal.getEvalVal().getType() = resTy;
         if (base.hasRef()) {
             NodeVal &baseRefee = EvalVal::getRefee(base.getEvalVal(), symbolTable);
-            nodeVal.getEvalVal().getRef() = &baseRefee.getEvalVal().elems()[ind];
+            nodeVal.getEvalVal().getRef() = EvalVal::ElemPointer(&baseRefee.getEvalVal().elems()[ind], getOwnerForPointersInto(base.getEvalVal().getRef()));
         }
         return nodeVal;
     }
 }
 
+NodeVal Evaluator::performOperIndex(CodeLoc codeLoc, VarId varId, std::uint64_t ind, TypeTable::Id resTy) {
+    NodeVal &var = symbolTable->getVar(varId).var;
+
+    // invoke args are loaded as they are stored
+    if (var.isInvokeArg()) return performOperIndex(codeLoc, var, ind, resTy);
+
+    // other vars are loaded with a ref to themselves, which elements get their refs from
+    var.getEvalVal().getRef() = varId;
+    NodeVal nodeVal = performOperIndex(codeLoc, var, ind, resTy);
+    var.getEvalVal().removeRef();
+    return nodeVal;
+}
+
+bool Evaluator::performRawAppend(CodeLoc codeLoc, VarId varId, NodeVal rhs) {
+    if (!checkIsEvalVal(rhs, true)) return false;
+
+    // pointers stored in outer scopes must not outlive their pointees
+    LifetimeInfo::NestLevel varNestLevel = symbolTable->getNestLevel(varId);
+    if (holdsPointer(rhs) && varNestLevel.greaterThan(symbolTable->currNestLevel()) &&
+        !checkPointeesOutlive(rhs.getCodeLoc(), rhs, varNestLevel)) {
+        return false;
+    }
+
+    NodeVal &var = symbolTable->getVar(varId).var;
+
+    EvalVal evalVal = EvalVal::makeVal(rhs.getType().value(), typeTable);
+    evalVal.elems() = move(var.getEvalVal().elems());
+    vector<NodeVal> &rhsElems = rhs.getEvalVal().elems();
+    evalVal.elems().insert(evalVal.elems().end(), make_move_iterator(rhsElems.begin()), make_move_iterator(rhsElems.end()));
+    evalVal.getLifetimeInfo() = var.getEvalVal().getLifetimeInfo();
+
+    var = NodeVal(var.getCodeLoc(), move(evalVal));
+    return true;
+}
+
 // TODO warn on over/underflow; are results correct in these cases?
 NodeVal Evaluator::performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, OperRegAttrs attrs) {
     if (!checkIsEvalVal(lhs, true) || !checkIsEvalVal(rhs, true)) return NodeVal();
@@ -703,6 +811,24 @@ NodeVal Evaluator::performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const
     EvalVal evalVal = EvalVal::makeVal(ty, typeTable);
     bool success = false, errorGiven = false;
 
+    if (typeTable->worksAsTypeVec(ty)) {
+        // vectors are operated on lane by lane
+        for (size_t i = 0; i < evalVal.elems().size(); ++i) {
+            NodeVal lhsElem = NodeVal::copyNoRef(lhs.getCodeLoc(), lhs.getEvalVal().elems()[i]);
+            NodeVal rhsElem = NodeVal::copyNoRef(rhs.getCodeLoc(), rhs.getEvalVal().elems()[i]);
+
+            if (op == Oper::DIV && EvalVal::isZero(rhsElem.getEvalVal(), typeTable)) {
+                msgs->errorExprBinDivByZero(rhsElem.getCodeLoc());
+                return NodeVal();
+            }
+
+            evalVal.elems()[i] = performOperRegular(codeLoc, lhsElem, rhsElem, op, attrs);
+            if (evalVal.elems()[i].isInvalid()) return NodeVal();
+        }
+
+        return NodeVal(codeLoc, move(evalVal));
+    }
+
     bool isTypeI = typeTable->worksAsTypeI(ty);
     bool isTypeU = typeTable->worksAsTypeU(ty);
     bool isTypeF = typeTable->worksAsTypeF(ty);
@@ -836,6 +962,92 @@ optional<uint64_t> Evaluator::performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) {
     return nullopt;
 }
 
+// evaluation is single-threaded, so atomics are plain loads and stores here
+
+NodeVal Evaluator::performAtomicLoad(CodeLoc codeLoc, const NodeVal &ptr, TypeTable::Id resTy, AtomicAttrs attrs) {
+    if (!checkIsEvalVal(ptr, true)) return NodeVal();
+
+    if (EvalVal::isNull(ptr.getEvalVal(), typeTable)) {
+        msgs->errorExprDerefNull(codeLoc);
+        return NodeVal();
+    }
+
+    NodeVal nodeEvalVal = NodeVal::copyNoRef(codeLoc, EvalVal::getPointee(ptr.getEvalVal(), symbolTable));
+    nodeEvalVal.getEvalVal().getType() = resTy;
+    return nodeEvalVal;
+}
+
+bool Evaluator::performAtomicStore(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicAttrs attrs) {
+    if (!checkIsEvalVal(ptr, true) || !checkIsEvalVal(val, true)) return false;
+
+    if (EvalVal::isNull(ptr.getEvalVal(), typeTable)) {
+        msgs->errorExprDerefNull(codeLoc);
+        return false;
+    }
+
+    if (holdsPointer(val)) {
+        optional<LifetimeInfo::NestLevel> pointeeNestLevel = getPointeeNestLevel(ptr.getEvalVal().p());
+        if (pointeeNestLevel.has_value() && pointeeNestLevel.value().greaterThan(symbolTable->currNestLevel()) &&
+            !checkPointeesOutlive(val.getCodeLoc(), val, pointeeNestLevel.value())) {
+            return false;
+        }
+    }
+
+    NodeVal &pointee = EvalVal::getPointee(ptr.getEvalVal(), symbolTable);
+    moveKeepingElems(pointee, NodeVal::copyNoRef(pointee.getCodeLoc(), val, pointee.getEvalVal().getLifetimeInfo()));
+
+    return true;
+}
+
+NodeVal Evaluator::performAtomicRmw(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicOp op, TypeTable::Id resTy, AtomicAttrs attrs) {
+    NodeVal old = performAtomicLoad(codeLoc, ptr, resTy, attrs);
+    if (old.isInvalid()) return NodeVal();
+
+    NodeVal res;
+    if (op == AtomicOp::XCHG) {
+        res = val;
+    } else if (op == AtomicOp::MIN || op == AtomicOp::MAX) {
+        ComparisonSignal signal;
+        if (!performOperComparison(codeLoc, val, old, Oper::LT, signal).has_value()) return NodeVal();
+
+        res = (op == AtomicOp::MIN) == signal.result ? val : old;
+    } else {
+        Oper oper;
+        if (op == AtomicOp::ADD) oper = Oper::ADD;
+        else if (op == AtomicOp::SUB) oper = Oper::SUB;
+        else if (op == AtomicOp::AND) oper = Oper::BIT_AND;
+        else if (op == AtomicOp::OR) oper = Oper::BIT_OR;
+        else oper = Oper::BIT_XOR;
+
+        res = performOperRegular(codeLoc, old, val, oper, OperRegAttrs());
+        if (res.isInvalid()) return NodeVal();
+    }
+
+    if (!performAtomicStore(codeLoc, ptr, res, attrs)) return NodeVal();
+
+    return old;
+}
+
+NodeVal Evaluator::performAtomicCmpXchg(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &expected, const NodeVal &desired, TypeTable::Id resTy, AtomicAttrs attrs) {
+    NodeVal old = performAtomicLoad(codeLoc, ptr, expected.getType().value(), attrs);
+    if (old.isInvalid()) return NodeVal();
+
+    ComparisonSignal signal;
+    if (!performOperComparison(codeLoc, old, expected, Oper::EQ, signal).has_value()) return NodeVal();
+
+    // weak ones never fail spuriously here
+    if (signal.result && !performAtomicStore(codeLoc, ptr, desired, attrs)) return NodeVal();
+
+    EvalVal evalVal = EvalVal::makeVal(resTy, typeTable);
+    evalVal.elems()[0] = move(old);
+    evalVal.elems()[1].getEvalVal().b() = signal.result;
+    return NodeVal(codeLoc, move(evalVal));
+}
+
+bool Evaluator::performFence(CodeLoc codeLoc, AtomicAttrs attrs) {
+    return true;
+}
+
 NodeVal Evaluator::doBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success, bool jumpingOut) {
     if (!success) return NodeVal();
 
@@ -853,6 +1065,347 @@ NodeVal Evaluator::doBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bo
     return NodeVal(codeLoc);
 }
 
+NodeVal Evaluator::doCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) {
+    const FuncValue &func = symbolTable->getFunc(funcId);
+
+    if (!checkIsEvalFunc(codeLocFunc, func, true)) return NodeVal();
+
+    for (const NodeVal &arg : args) {
+        if (!checkIsEvalVal(arg, true)) return NodeVal();
+    }
+
+    if (!func.defined) {
+        msgs->errorFuncNoDef(codeLocFunc);
+        return NodeVal();
+    }
+    if (!func.isEvalFunc || func.evalFunc == nullptr || func.evalFunc->isInvalid()) {
+        msgs->errorInternal(codeLocFunc);
+        return NodeVal();
+    }
+
+    BlockRaii blockRaii(symbolTable, SymbolTable::CalleeValueInfo::make(func, typeTable));
+
+    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        LifetimeInfo lifetimeInfo;
+        lifetimeInfo.noDrop = callable.getArgNoDrop(i);
+        lifetimeInfo.nestLevel = symbolTable->currNestLevel();
+
+        SymbolTable::VarEntry varEntry;
+        varEntry.name = func.argNames[i];
+        varEntry.var = NodeVal::copyNoRef(args[i], lifetimeInfo);
+        symbolTable->addVar(move(varEntry));
+    }
+
+    bool retIssued = false;
+    try {
+        if (!processChildNodes(*func.evalFunc)) {
+            return NodeVal();
+        }
+    } catch (ExceptionEvaluatorJump ex) {
+        tailCallCand = nullptr;
+
+        if (!ex.isRet) {
+            msgs->errorInternal(codeLoc);
+            return NodeVal();
+        }
+        retIssued = true;
+    }
+
+    // the result will come from the tail call
+    if (tailCall.has_value()) return NodeVal(codeLoc);
+
+    if (!retIssued && !callDropFuncsCurrCallable(codeLoc)) return NodeVal();
+
+    if (callable.hasRet()) {
+        if (!retVal.has_value()) {
+            msgs->errorRetNoValue(codeLoc, callable.retType.value());
+            return NodeVal();
+        }
+
+        CodeLoc codeLocRet = retVal.value().getCodeLoc();
+        NodeVal ret = NodeVal::moveNoRef(codeLoc, move(retVal.value()), LifetimeInfo());
+        retVal.reset();
+
+        // this frame is about to be left, but the result may be kept anywhere in the caller's
+        LifetimeInfo::NestLevel callerNestLevel{symbolTable->currNestLevel().callable-1, UINT32_MAX};
+        if (holdsPointer(ret) && !checkPointeesOutlive(codeLocRet, ret, callerNestLevel)) return NodeVal();
+
+        return ret;
+    } else {
+        return NodeVal(codeLoc);
+    }
+}
+
+NodeVal Evaluator::doInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args) {
+    const MacroValue &macro = symbolTable->getMacro(macroId);
+
+    LifetimeInfo::NestLevel nestLevel = symbolTable->currNestLevel();
+
+    BlockRaii blockRaii(symbolTable, SymbolTable::CalleeValueInfo::make(macro));
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        SymbolTable::VarEntry varEntry;
+        varEntry.name = macro.argNames[i];
+        varEntry.var = move(args[i]);
+
+        if (varEntry.var.getLifetimeInfo().has_value()) {
+            LifetimeInfo lifetimeInfo = varEntry.var.getLifetimeInfo().value();
+            lifetimeInfo.invokeArg = true;
+            varEntry.var.setLifetimeInfo(lifetimeInfo);
+        }
+
+        symbolTable->addVar(move(varEntry));
+    }
+
+    try {
+        if (!processChildNodes(*macro.body)) {
+            return NodeVal();
+        }
+    } catch (ExceptionEvaluatorJump ex) {
+        tailCallCand = nullptr;
+
+        if (!ex.isRet) {
+            msgs->errorInternal(codeLoc);
+            return NodeVal();
+        }
+    }
+
+    if (!callDropFuncsCurrCallable(codeLoc)) return NodeVal();
+
+    if (!retVal.has_value()) {
+        msgs->errorMacroNoRet(codeLoc);
+        return NodeVal();
+    }
+
+    NodeVal ret = move(retVal.value());
+    retVal.reset();
+    ret.setCodeLoc(codeLoc);
+    return move(ret);
+}
+
+bool Evaluator::enterFrame(CodeLoc codeLoc, variant<FuncId, MacroId> callee) {
+    if (frames.size() >= depthLimit) {
+        msgs->errorEvalCallDepth(codeLoc, depthLimit);
+        printBacktrace();
+        return false;
+    }
+
+    Frame frame;
+    frame.codeLoc = codeLoc;
+    frame.callee = callee;
+    if (profiling) {
+        if (holds_alternative<FuncId>(callee)) frame.profile = &funcProfiles[get<FuncId>(callee)];
+        else frame.profile = &macroProfiles[get<MacroId>(callee)];
+        ++frame.profile->active;
+        frame.start = chrono::steady_clock::now();
+    }
+    frames.push_back(frame);
+
+    return true;
+}
+
+void Evaluator::exitFrame() {
+    Frame frame = frames.back();
+    frames.pop_back();
+
+    if (frame.profile == nullptr) return;
+
+    chrono::steady_clock::duration elapsed = chrono::steady_clock::now()-frame.start;
+
+    ProfileEntry &profile = *frame.profile;
+    ++profile.calls;
+    profile.nodes += frame.nodes;
+    profile.exclusive += elapsed-frame.inner;
+    --profile.active;
+    if (profile.active == 0) profile.inclusive += elapsed;
+
+    if (!frames.empty()) frames.back().inner += elapsed;
+}
+
+bool Evaluator::countStep(CodeLoc codeLoc) {
+    ++steps;
+    if (!frames.empty()) ++frames.back().nodes;
+
+    if (stepLimit.has_value() && steps > stepLimit.value()) {
+        // the failure propagates through all the nodes being processed, but gets reported once
+        if (steps-1 == stepLimit.value()) {
+            msgs->errorEvalStepLimit(codeLoc, stepLimit.value());
+            printBacktrace();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void Evaluator::printBacktrace() {
+    const size_t shownMax = 16;
+
+    for (size_t i = 0; i < frames.size() && i < shownMax; ++i) {
+        const Frame &frame = frames[frames.size()-1-i];
+        if (holds_alternative<FuncId>(frame.callee)) {
+            msgs->hintWhileEvaluatingFunc(frame.codeLoc, symbolTable->getFunc(get<FuncId>(frame.callee)).name);
+        } else {
+            msgs->hintWhileInvokingMacro(frame.codeLoc, symbolTable->getMacro(get<MacroId>(frame.callee)).name);
+        }
+    }
+    if (frames.size() > shownMax) msgs->hintEvalFramesOmitted(frames.size()-shownMax);
+}
+
+bool Evaluator::hasDropFunc(TypeTable::Id ty) {
+    if (typeTable->worksAsTypeArr(ty)) {
+        return hasDropFunc(typeTable->addTypeIndexOf(ty).value());
+    } else if (typeTable->worksAsTuple(ty)) {
+        size_t len = typeTable->extractLenOfTuple(ty).value();
+        for (size_t i = 0; i < len; ++i) {
+            if (hasDropFunc(typeTable->extractTupleElementType(ty, i).value())) return true;
+        }
+    } else if (typeTable->worksAsDataType(ty)) {
+        if (symbolTable->getDropFunc(typeTable->extractExplicitTypeBaseType(ty)) != nullptr) return true;
+
+        size_t len = typeTable->extractLenOfDataType(ty).value();
+        for (size_t i = 0; i < len; ++i) {
+            if (hasDropFunc(typeTable->extractDataTypeElementType(ty, i).value())) return true;
+        }
+    }
+
+    return false;
+}
+
+bool Evaluator::holdsPointer(const NodeVal &val) const {
+    if (!val.isEvalVal()) return false;
+
+    const EvalVal &evalVal = val.getEvalVal();
+    if (EvalVal::isP(evalVal, typeTable)) return !EvalVal::isNull(evalVal.p());
+    if (EvalVal::isArrP(evalVal, typeTable)) return evalVal.arrP().elems != nullptr;
+
+    if (EvalVal::isRaw(evalVal, typeTable) || EvalVal::isArr(evalVal, typeTable) || EvalVal::isVec(evalVal, typeTable) ||
+        EvalVal::isTuple(evalVal, typeTable) || EvalVal::isDataType(evalVal, typeTable)) {
+        for (const NodeVal &elem : evalVal.elems()) {
+            if (elem.hasRef() || holdsPointer(elem)) return true;
+        }
+    }
+
+    return false;
+}
+
+optional<LifetimeInfo::NestLevel> Evaluator::getPointeeNestLevel(const EvalVal::Pointer &ptr) const {
+    if (EvalVal::isNull(ptr)) return nullopt;
+    if (holds_alternative<VarId>(ptr)) return symbolTable->getNestLevel(get<VarId>(ptr));
+
+    LifetimeInfo::NestLevel owner = holds_alternative<EvalVal::ArrPointer>(ptr) ? get<EvalVal::ArrPointer>(ptr).owner : get<EvalVal::ElemPointer>(ptr).owner;
+    if (owner.local == 0) return nullopt;
+    return owner;
+}
+
+LifetimeInfo::NestLevel Evaluator::getOwnerForPointersInto(const EvalVal::Pointer &ref) const {
+    return getPointeeNestLevel(ref).value_or(LifetimeInfo::NestLevel{0, 0});
+}
+
+bool Evaluator::checkPointeesOutlive(CodeLoc codeLoc, const NodeVal &val, LifetimeInfo::NestLevel nestLevel) {
+    if (!val.isEvalVal()) return true;
+
+    const EvalVal &evalVal = val.getEvalVal();
+    optional<EvalVal::Pointer> ptr;
+    if (EvalVal::isP(evalVal, typeTable)) ptr = evalVal.p();
+    else if (EvalVal::isArrP(evalVal, typeTable)) ptr = evalVal.arrP();
+
+    if (ptr.has_value()) {
+        optional<LifetimeInfo::NestLevel> pointeeNestLevel = getPointeeNestLevel(ptr.value());
+        if (pointeeNestLevel.has_value() && nestLevel.greaterThan(pointeeNestLevel.value())) {
+            msgs->errorExprPointerOutlivesPointee(codeLoc);
+            return false;
+        }
+        return true;
+    }
+
+    if (EvalVal::isRaw(evalVal, typeTable) || EvalVal::isArr(evalVal, typeTable) || EvalVal::isVec(evalVal, typeTable) ||
+        EvalVal::isTuple(evalVal, typeTable) || EvalVal::isDataType(evalVal, typeTable)) {
+        for (const NodeVal &elem : evalVal.elems()) {
+            if (!checkPointeesOutlive(codeLoc, elem, nestLevel)) return false;
+        }
+    }
+
+    return true;
+}
+
+bool Evaluator::mayTailCall(FuncId funcId, const std::vector<NodeVal> &args) {
+    optional<SymbolTable::CalleeValueInfo> callee = symbolTable->getCurrCallee();
+    if (!callee.has_value() || !callee.value().isFunc || !callee.value().isEval) return false;
+
+    const FuncValue &func = symbolTable->getFunc(funcId);
+    if (!func.isEval() || !func.defined || func.memoize) return false;
+
+    // the result must be returnable as is
+    TypeTable::Callable callable = FuncValue::getCallable(func, typeTable);
+    if (!callable.hasRet() || callable.retType != callee.value().retType) return false;
+
+    // nothing may get dropped, as that would otherwise happen after the call
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i < callable.getArgCnt() && callable.getArgNoDrop(i)) return false;
+    }
+    // args may not point into the frame about to be left
+    for (const NodeVal &arg : args) {
+        if (holdsPointer(arg)) return false;
+    }
+    for (const auto &it : symbolTable->getValsForDropCurrCallable()) {
+        if (holds_alternative<VarId>(it)) {
+            const SymbolTable::VarEntry &varEntry = symbolTable->getVar(get<VarId>(it));
+            if (varEntry.skipDrop || varEntry.var.isNoDrop() || varEntry.var.isInvokeArg()) continue;
+            if (varEntry.var.getType().has_value() && hasDropFunc(varEntry.var.getType().value())) return false;
+        } else {
+            const NodeVal &val = get<NodeVal>(it);
+            if (val.isNoDrop() || val.isInvokeArg()) continue;
+            if (val.getType().has_value() && hasDropFunc(val.getType().value())) return false;
+        }
+    }
+
+    return true;
+}
+
+void Evaluator::tryTailCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, std::vector<NodeVal> &args) {
+    if (!mayTailCall(funcId, args)) return;
+
+    TailCall call;
+    call.codeLoc = codeLoc;
+    call.codeLocFunc = codeLocFunc;
+    call.funcId = funcId;
+    call.args.reserve(args.size());
+    // args may refer to vars of the frame about to be left
+    for (NodeVal &arg : args) call.args.push_back(NodeVal::moveNoRef(move(arg), LifetimeInfo()));
+    tailCall = move(call);
+
+    ExceptionEvaluatorJump ex;
+    ex.isRet = true;
+    throw ex;
+}
+
+void Evaluator::tryTailCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, std::vector<NodeVal> &args) {
+    if (!func.isEvalVal() || !func.getEvalVal().f().has_value()) return;
+
+    tryTailCall(codeLoc, codeLocFunc, *func.getEvalVal().f(), args);
+}
+
+optional<size_t> Evaluator::hashArgsForMemo(const std::vector<NodeVal> &args) const {
+    size_t hash = args.size();
+    for (const NodeVal &arg : args) {
+        optional<size_t> argHash = NodeVal::hashStructurally(arg, typeTable);
+        if (!argHash.has_value()) return nullopt;
+        hash = leNiceHasheFunctione(hash, argHash.value());
+    }
+    return hash;
+}
+
+bool Evaluator::equalArgsForMemo(const std::vector<NodeVal> &l, const std::vector<NodeVal> &r) const {
+    if (l.size() != r.size()) return false;
+    for (size_t i = 0; i < l.size(); ++i) {
+        if (!NodeVal::equalStructurally(l[i], r[i], typeTable)) return false;
+    }
+    return true;
+}
+
 optional<NodeVal> Evaluator::makeCast(CodeLoc codeLoc, const NodeVal &srcVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId) {
     // TODO early catch case when just changing constness
     if (srcTypeId == dstTypeId) return NodeVal::copyNoRef(codeLoc, srcVal);
@@ -860,7 +1413,32 @@ optional<NodeVal> Evaluator::makeCast(CodeLoc codeLoc, const NodeVal &srcVal, Ty
     const EvalVal &srcEvalVal = srcVal.getEvalVal();
     EvalVal dstEvalVal = EvalVal::makeVal(dstTypeId, typeTable);
 
-    if (typeTable->worksAsTypeI(srcTypeId)) {
+    if (typeTable->worksAsTypeVec(dstTypeId)) {
+        size_t len = typeTable->extractLenOfVec(dstTypeId).value();
+        TypeTable::Id dstElemTypeId = typeTable->addTypeIndexOf(dstTypeId).value();
+
+        if (typeTable->worksAsTypeVec(srcTypeId)) {
+            if (typeTable->extractLenOfVec(srcTypeId).value() != len) return nullopt;
+
+            TypeTable::Id srcElemTypeId = typeTable->addTypeIndexOf(srcTypeId).value();
+            for (size_t i = 0; i < len; ++i) {
+                optional<NodeVal> elemCast = makeCast(codeLoc, srcEvalVal.elems()[i], srcElemTypeId, dstElemTypeId);
+                if (!elemCast.has_value()) return nullopt;
+
+                dstEvalVal.elems()[i] = move(elemCast.value());
+            }
+        } else if (typeTable->worksAsPrimitive(srcTypeId)) {
+            // splat
+            optional<NodeVal> elemCast = makeCast(codeLoc, srcVal, srcTypeId, dstElemTypeId);
+            if (!elemCast.has_value()) return nullopt;
+
+            for (size_t i = 0; i < len; ++i) {
+                dstEvalVal.elems()[i] = elemCast.value();
+            }
+        } else {
+            return nullopt;
+        }
+    } else if (typeTable->worksAsTypeI(srcTypeId)) {
         int64_t x = EvalVal::getValueI(srcEvalVal, typeTable).value();
         if (!assignBasedOnTypeI(dstEvalVal, (int64_t) x, dstTypeId) &&
             !assignBasedOnTypeU(dstEvalVal, (uint64_t) x, dstTypeId) &&
@@ -945,7 +1523,39 @@ optional<NodeVal> Evaluator::makeCast(CodeLoc codeLoc, const NodeVal &srcVal, Ty
                 return nullopt;
             }
         } else {
-            if (typeTable->isImplicitCastable(typeTable->extractExplicitTypeBaseType(srcTypeId), typeTable->extractExplicitTypeBaseType(dstTypeId))) {
+            TypeTable::Id srcBaseTypeId = typeTable->extractExplicitTypeBaseType(srcTypeId);
+            TypeTable::Id dstBaseTypeId = typeTable->extractExplicitTypeBaseType(dstTypeId);
+
+            // pointed elements must be of the same type, up to constness
+            auto isElemCastable = [&](TypeTable::Id srcElemTypeId, TypeTable::Id dstElemTypeId) {
+                return typeTable->isImplicitCastable(typeTable->addTypeAddrOf(srcElemTypeId), typeTable->addTypeAddrOf(dstElemTypeId));
+            };
+
+            if (typeTable->worksAsTypeB(dstTypeId)) {
+                dstEvalVal.b() = true;
+            } else if (EvalVal::isArrP(dstEvalVal, typeTable)) {
+                TypeTable::Id dstElemTypeId = typeTable->addTypeIndexOf(dstBaseTypeId).value();
+
+                if (EvalVal::isArrP(srcEvalVal, typeTable)) {
+                    if (!typeTable->isImplicitCastable(srcBaseTypeId, dstBaseTypeId)) return nullopt;
+                    dstEvalVal.arrP() = srcEvalVal.arrP();
+                } else if (EvalVal::isP(srcEvalVal, typeTable)) {
+                    // pointers to array elements move along that array, pointers to arrays point to their start
+                    TypeTable::Id pointeeTypeId = typeTable->addTypeDerefOf(srcBaseTypeId).value();
+                    if (holds_alternative<EvalVal::ArrPointer>(srcEvalVal.p()) && isElemCastable(pointeeTypeId, dstElemTypeId)) {
+                        dstEvalVal.arrP() = get<EvalVal::ArrPointer>(srcEvalVal.p());
+                    } else if (typeTable->worksAsTypeArr(pointeeTypeId) && isElemCastable(typeTable->addTypeIndexOf(pointeeTypeId).value(), dstElemTypeId)) {
+                        dstEvalVal.arrP() = EvalVal::makeArrPointer(EvalVal::getPointee(srcEvalVal, symbolTable), getOwnerForPointersInto(srcEvalVal.p()));
+                    } else {
+                        return nullopt;
+                    }
+                } else {
+                    return nullopt;
+                }
+            } else if (EvalVal::isArrP(srcEvalVal, typeTable) && typeTable->worksAsTypeP(dstTypeId)) {
+                if (!isElemCastable(typeTable->addTypeIndexOf(srcBaseTypeId).value(), typeTable->addTypeDerefOf(dstBaseTypeId).value())) return nullopt;
+                dstEvalVal.p() = srcEvalVal.arrP();
+            } else if (typeTable->isImplicitCastable(srcBaseTypeId, dstBaseTypeId)) {
                 if (!assignBasedOnTypeP(dstEvalVal, srcEvalVal.p(), dstTypeId)) {
                     return nullopt;
                 }
@@ -1130,6 +1740,25 @@ bool Evaluator::assignBasedOnTypeP(EvalVal &val, EvalVal::Pointer x, TypeTable::
     return true;
 }
 
+void Evaluator::moveKeepingElems(NodeVal &dst, NodeVal &&src) {
+    auto hasElems = [&](const NodeVal &node) {
+        if (!node.isEvalVal()) return false;
+        const EvalVal &val = node.getEvalVal();
+        return EvalVal::isArr(val, typeTable) || EvalVal::isVec(val, typeTable) ||
+            EvalVal::isTuple(val, typeTable) || EvalVal::isDataType(val, typeTable);
+    };
+
+    if (hasElems(dst) && hasElems(src) && dst.getEvalVal().elems().size() == src.getEvalVal().elems().size()) {
+        vector<NodeVal> &dstElems = dst.getEvalVal().elems(), &srcElems = src.getEvalVal().elems();
+        for (size_t i = 0; i < dstElems.size(); ++i) {
+            moveKeepingElems(dstElems[i], move(srcElems[i]));
+        }
+        swap(dstElems, srcElems);
+    }
+
+    dst = move(src);
+}
+
 bool Evaluator::assignBasedOnTypeId(EvalVal &val, std::uint64_t x, TypeTable::Id ty) {
     if (typeTable->worksAsPrimitive(ty, TypeTable::P_ID)) {
         val.id() = makeIdFromU(x);
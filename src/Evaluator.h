@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <variant>
 #include "Processor.h"
+#include "ProgramArgs.h"
 
 class Evaluator : public Processor {
     friend class Processor;
@@ -8,6 +13,44 @@ class Evaluator : public Processor {
     // TODO put this into an exception?
     std::optional<NodeVal> retVal;
 
+    struct TailCall {
+        CodeLoc codeLoc, codeLocFunc;
+        FuncId funcId;
+        std::vector<NodeVal> args;
+    };
+
+    // set when the evaluated function being left made a call in its ret
+    std::optional<TailCall> tailCall;
+    // value node of the ret being processed, until a call or a jump happens
+    const NodeVal *tailCallCand = nullptr;
+
+    struct ProfileEntry {
+        std::uint64_t calls = 0, nodes = 0;
+        std::chrono::steady_clock::duration inclusive{}, exclusive{};
+        // recursive calls are only counted once towards inclusive time
+        unsigned active = 0;
+    };
+
+    struct Frame {
+        CodeLoc codeLoc;
+        std::variant<FuncId, MacroId> callee;
+        ProfileEntry *profile = nullptr;
+        std::uint64_t nodes = 0;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::duration inner{};
+    };
+
+    // active evaluated calls and macro invocations, innermost last
+    std::vector<Frame> frames;
+    unsigned depthLimit;
+
+    std::uint64_t steps = 0;
+    std::optional<std::uint64_t> stepLimit;
+
+    bool profiling;
+    std::unordered_map<FuncId, ProfileEntry, FuncId::Hasher> funcProfiles;
+    std::unordered_map<MacroId, ProfileEntry, MacroId::Hasher> macroProfiles;
+
     bool assignBasedOnTypeI(EvalVal &val, std::int64_t x, TypeTable::Id ty);
     bool assignBasedOnTypeU(EvalVal &val, std::uint64_t x, TypeTable::Id ty);
     bool assignBasedOnTypeF(EvalVal &val, double x, TypeTable::Id ty);
@@ -16,6 +59,12 @@ class Evaluator : public Processor {
     bool assignBasedOnTypeP(EvalVal &val, EvalVal::Pointer x, TypeTable::Id ty);
     bool assignBasedOnTypeId(EvalVal &val, std::uint64_t x, TypeTable::Id ty);
     bool assignBasedOnTypeId(EvalVal &val, bool x, TypeTable::Id ty);
+    // array pointers may point into dst elements, so their storage is kept in place
+    void moveKeepingElems(NodeVal &dst, NodeVal &&src);
+    // same as indexing what performLoad returns for the var, without copying its other elements
+    NodeVal performOperIndex(CodeLoc codeLoc, VarId varId, std::uint64_t ind, TypeTable::Id resTy);
+    // same as assigning the concatenation of the raw var and rhs, without copying the var's elements
+    bool performRawAppend(CodeLoc codeLoc, VarId varId, NodeVal rhs);
 
     std::optional<NodeVal> makeCast(CodeLoc codeLoc, const NodeVal &srcVal, TypeTable::Id srcTypeId, TypeTable::Id dstTypeId);
     std::optional<EvalVal> makeArray(TypeTable::Id arrTypeId);
@@ -25,6 +74,29 @@ class Evaluator : public Processor {
     NamePool::Id makeIdConcat(NamePool::Id lhs, NamePool::Id rhs, bool bare);
     std::vector<NodeVal> makeRawConcat(const EvalVal &lhs, const EvalVal &rhs) const;
 
+    // nullopt if args can't be compared structurally
+    std::optional<std::size_t> hashArgsForMemo(const std::vector<NodeVal> &args) const;
+    bool equalArgsForMemo(const std::vector<NodeVal> &l, const std::vector<NodeVal> &r) const;
+
+    NodeVal doCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args);
+    NodeVal doInvoke(CodeLoc codeLoc, MacroId macroId, std::vector<NodeVal> args);
+    bool enterFrame(CodeLoc codeLoc, std::variant<FuncId, MacroId> callee);
+    void exitFrame();
+    bool countStep(CodeLoc codeLoc);
+    void printBacktrace();
+    bool hasDropFunc(TypeTable::Id ty);
+    // ignores the ref of val itself, but not of its elements
+    bool holdsPointer(const NodeVal &val) const;
+    // of the var holding the pointee, nullopt if null or not in a var
+    std::optional<LifetimeInfo::NestLevel> getPointeeNestLevel(const EvalVal::Pointer &ptr) const;
+    // owner to record in pointers into the value that ref refers to
+    LifetimeInfo::NestLevel getOwnerForPointersInto(const EvalVal::Pointer &ref) const;
+    bool checkPointeesOutlive(CodeLoc codeLoc, const NodeVal &val, LifetimeInfo::NestLevel nestLevel);
+    bool mayTailCall(FuncId funcId, const std::vector<NodeVal> &args);
+    // throws if the call is to be made in place of the current function
+    void tryTailCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, std::vector<NodeVal> &args);
+    void tryTailCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, std::vector<NodeVal> &args);
+
     NodeVal doBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success, bool jumpingOut);
 
 public:
@@ -32,15 +104,16 @@ public:
     NodeVal performLoad(CodeLoc codeLoc, FuncId funcId) override;
     NodeVal performLoad(CodeLoc codeLoc, MacroId macroId) override;
     NodeVal performZero(CodeLoc codeLoc, TypeTable::Id ty) override;
-    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) override;
-    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) override;
+    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty, SymAttrs attrs) override;
+    NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init, SymAttrs attrs) override;
     NodeVal performCast(CodeLoc codeLoc, const NodeVal &node, CodeLoc codeLocTy, TypeTable::Id ty) override;
     bool performBlockSetUp(CodeLoc codeLoc, SymbolTable::Block &block) override { return true; }
     std::optional<bool> performBlockBody(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &nodeBody) override;
     NodeVal performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success) override;
-    bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
-    bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) override;
+    bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) override;
+    bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) override;
     bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) override;
+    bool performBranch(CodeLoc codeLoc, const NodeVal &val, const std::vector<std::vector<NodeVal>> &caseVals, const std::vector<const NodeVal*> &bodies) override;
     bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) override { return true; }
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) override;
     NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) override;
@@ -55,12 +128,20 @@ public:
     ComparisonSignal performOperComparisonSetUp(CodeLoc codeLoc, std::size_t opersCnt) override;
     std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) override;
     NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) override;
+    NodeVal performOperComparisonVec(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, TypeTable::Id resTy) override;
     NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) override;
     NodeVal performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) override;
     NodeVal performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_t ind, TypeTable::Id resTy) override;
     NodeVal performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, OperRegAttrs attrs) override;
     std::optional<std::uint64_t> performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) override;
+    NodeVal performAtomicLoad(CodeLoc codeLoc, const NodeVal &ptr, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    bool performAtomicStore(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicAttrs attrs) override;
+    NodeVal performAtomicRmw(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicOp op, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    NodeVal performAtomicCmpXchg(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &expected, const NodeVal &desired, TypeTable::Id resTy, AtomicAttrs attrs) override;
+    bool performFence(CodeLoc codeLoc, AtomicAttrs attrs) override;
 
 public:
-    Evaluator(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs);
+    Evaluator(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs, const ProgramArgs &args);
+
+    void printProfile(std::ostream &out) const;
 };
\ No newline at end of file
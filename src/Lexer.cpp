@@ -125,8 +125,7 @@ Token Lexer::next() {
     while (true) {
         char ch;
         do {
-            codeLocPoint.ln = ln;
-            codeLocPoint.col = col+1; // text editors are 1-indexed
+            codeLocPoint = CodeLocPoint::make(ln, col+1); // text editors are 1-indexed
             ch = nextCh();
         } while (isspace(ch));
 
@@ -145,8 +144,7 @@ Token Lexer::next() {
                 } while (peekCh() != '#' && !over());
 
                 if (over()) {
-                    CodeLocPoint codeLocPointEnd = codeLocPoint;
-                    codeLocPointEnd.col += 2;
+                    CodeLocPoint codeLocPointEnd = CodeLocPoint::make(codeLocPoint.ln, codeLocPoint.col+2);
 
                     tok.type = Token::T_UNKNOWN;
                     msgs->errorUnclosedMultilineComment({fileId, codeLocPoint, codeLocPointEnd});
@@ -190,8 +188,7 @@ Token Lexer::next() {
             UnescapePayload unesc = unescape(line, col, true);
 
             if (unesc.status != UnescapePayload::Status::Success || unesc.unescaped.size() != 1) {
-                CodeLocPoint codeLocPointEnd = codeLocPoint;
-                codeLocPointEnd.col += 1;
+                CodeLocPoint codeLocPointEnd = CodeLocPoint::make(codeLocPoint.ln, codeLocPoint.col+1);
 
                 tok.type = Token::T_UNKNOWN;
                 msgs->errorBadLiteral({fileId, codeLocPoint, codeLocPointEnd});
@@ -235,8 +232,7 @@ Token Lexer::next() {
             }
 
             if (!success) {
-                CodeLocPoint codeLocPointEnd = codeLocPoint;
-                codeLocPointEnd.col += 1;
+                CodeLocPoint codeLocPointEnd = CodeLocPoint::make(codeLocPoint.ln, codeLocPoint.col+1);
 
                 tok.type = Token::T_UNKNOWN;
                 msgs->errorBadLiteral({fileId, codeLocPoint, codeLocPointEnd});
@@ -1,11 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 
 struct LifetimeInfo {
     struct NestLevel {
-        std::size_t callable;
-        std::size_t local;
+        std::uint32_t callable;
+        std::uint32_t local;
 
         bool equal(NestLevel other) const { return callable == other.callable && local == other.local; }
         bool callableGreaterThan(NestLevel other) const { return callable < other.callable; }
@@ -1,6 +1,14 @@
 #include "NodeVal.h"
+#include <algorithm>
+#include <limits>
+#include <type_traits>
 using namespace std;
 
+// parsed programs and raws are made of these, so make sure they don't grow unnoticed
+static_assert(sizeof(void*) != 8 || sizeof(NodeVal) <= 136, "NodeVal got larger.");
+// eval array pointers point into elems, which must stay in place when vectors of NodeVal grow
+static_assert(is_nothrow_move_constructible_v<NodeVal>, "NodeVal must be nothrow movable.");
+
 NodeVal::NodeVal() : value(false) {
 }
 
@@ -30,16 +38,13 @@ NodeVal::NodeVal(CodeLoc codeLoc, UndecidedCallableVal val) : codeLoc(codeLoc),
 
 void NodeVal::copyFrom(const NodeVal &other) {
     codeLoc = other.codeLoc;
+    holeFreeId = other.holeFreeId;
 
     value = other.value;
 
-    typeAttr.reset();
-    if (other.hasTypeAttr()) {
-        typeAttr = make_unique<NodeVal>(other.getTypeAttr());
-    }
-    nonTypeAttrs.reset();
-    if (other.hasNonTypeAttrs()) {
-        nonTypeAttrs = make_unique<NodeVal>(other.getNonTypeAttrs());
+    attrs.reset();
+    if (other.attrs != nullptr) {
+        attrs = make_unique<Attrs>(*other.attrs);
     }
 }
 
@@ -51,6 +56,23 @@ void NodeVal::operator=(const NodeVal &other) {
     if (this != &other) copyFrom(other);
 }
 
+bool NodeVal::isHoleFreeIn(const NodeVal &node, const NodeVal &child, const TypeTable *typeTable) {
+    return !child.hasTypeAttr() && !child.hasNonTypeAttrs() &&
+        child.getEscapeScore() >= node.getEscapeScore() &&
+        (isLeaf(child, typeTable) || child.isHoleFree());
+}
+
+void NodeVal::updateHoleFree(NodeVal &node, const TypeTable *typeTable, uint32_t &lastHoleFreeId) {
+    bool holeFree = !isLeaf(node, typeTable) &&
+        all_of(node.getEvalVal().elems().begin(), node.getEvalVal().elems().end(), [&](const NodeVal &child) {
+            return isHoleFreeIn(node, child, typeTable);
+        });
+
+    // ids must not get reused, so once they run out, nodes are no longer treated as hole-free
+    if (holeFree && lastHoleFreeId < numeric_limits<uint32_t>::max()) node.holeFreeId = ++lastHoleFreeId;
+    else node.holeFreeId = 0;
+}
+
 bool NodeVal::isEscaped() const {
     return (isLiteralVal() && getLiteralVal().isEscaped()) ||
         (isEvalVal() && getEvalVal().isEscaped());
@@ -131,14 +153,30 @@ void NodeVal::addChild(NodeVal &node, NodeVal c, TypeTable *typeTable) {
     if (isRawVal(c, typeTable) && typeTable->worksAsTypeCn(c.getEvalVal().getType()))
         node.getEvalVal().getType() = typeTable->addTypeCnOf(node.getEvalVal().getType());
 
+    node.holeFreeId = 0;
+
     node.getEvalVal().elems().push_back(move(c));
 }
 
 void NodeVal::addChildren(NodeVal &node, vector<NodeVal> c, TypeTable *typeTable) {
-    addChildren(node, c.begin(), c.end(), typeTable);
+    if (!node.getEvalVal().elems().empty()) {
+        addChildren(node, c.begin(), c.end(), typeTable);
+        return;
+    }
+
+    // take over the buffer instead of moving elements into a new one
+    bool setCn = any_of(c.begin(), c.end(), [typeTable](const NodeVal &child) {
+        return isRawVal(child, typeTable) && typeTable->worksAsTypeCn(child.getEvalVal().getType());
+    });
+    node.holeFreeId = 0;
+
+    node.getEvalVal().elems() = move(c);
+
+    if (setCn) node.getEvalVal().getType() = typeTable->addTypeCnOf(node.getEvalVal().getType());
 }
 
 void NodeVal::addChildren(NodeVal &node, vector<NodeVal>::iterator start, vector<NodeVal>::iterator end, TypeTable *typeTable) {
+    node.holeFreeId = 0;
     node.getEvalVal().elems().reserve(node.getChildrenCnt()+(end-start));
 
     bool setCn = false;
@@ -152,11 +190,25 @@ void NodeVal::addChildren(NodeVal &node, vector<NodeVal>::iterator start, vector
 }
 
 void NodeVal::setTypeAttr(NodeVal t) {
-    typeAttr = make_unique<NodeVal>(move(t));
+    if (attrs == nullptr) attrs = make_unique<Attrs>();
+    attrs->type = move(t);
+}
+
+void NodeVal::clearTypeAttr() {
+    if (attrs == nullptr) return;
+    attrs->type.reset();
+    if (!attrs->nonType.has_value()) attrs.reset();
 }
 
 void NodeVal::setNonTypeAttrs(NodeVal a) {
-    nonTypeAttrs = make_unique<NodeVal>(move(a));
+    if (attrs == nullptr) attrs = make_unique<Attrs>();
+    attrs->nonType = move(a);
+}
+
+void NodeVal::clearNonTypeAttrs() {
+    if (attrs == nullptr) return;
+    attrs->nonType.reset();
+    if (!attrs->type.has_value()) attrs.reset();
 }
 
 bool NodeVal::isEmpty(const NodeVal &node, const TypeTable *typeTable) {
@@ -202,8 +254,8 @@ void NodeVal::escape(NodeVal &node, const TypeTable *typeTable, EscapeScore amou
             }
         }
     } else if (node.isAttrMap()) {
-        for (auto &it : node.getAttrMap().attrMap) {
-            escape(*it.second, typeTable, amount);
+        for (auto &it : node.getAttrMap().vals) {
+            escape(it, typeTable, amount);
         }
     }
 
@@ -212,6 +264,9 @@ void NodeVal::escape(NodeVal &node, const TypeTable *typeTable, EscapeScore amou
 }
 
 void NodeVal::unescape(NodeVal &node, const TypeTable *typeTable, bool total) {
+    // children no longer keep their escape scores relative to this node's, so they may need to be promoted differently
+    if (total) node.holeFreeId = 0;
+
     if (node.isLiteralVal()) {
         if (total) node.getLiteralVal().escapeScore = 0;
         else node.getLiteralVal().escapeScore -= 1;
@@ -224,8 +279,8 @@ void NodeVal::unescape(NodeVal &node, const TypeTable *typeTable, bool total) {
         if (total) node.getEvalVal().getEscapeScore() = 0;
         else node.getEvalVal().getEscapeScore() -= 1;
     } else if (node.isAttrMap()) {
-        for (auto &it : node.getAttrMap().attrMap) {
-            unescape(*it.second, typeTable, total);
+        for (auto &it : node.getAttrMap().vals) {
+            unescape(it, typeTable, total);
         }
     }
 
@@ -251,6 +306,55 @@ NodeVal NodeVal::makeEmpty(CodeLoc codeLoc, TypeTable *typeTable) {
     return NodeVal(codeLoc, emptyRaw);
 }
 
+optional<size_t> NodeVal::hashStructurally(const NodeVal &node, const TypeTable *typeTable) {
+    optional<size_t> hash;
+    if (node.isEvalVal()) {
+        hash = EvalVal::hashStructurally(node.getEvalVal(), typeTable);
+    } else if (node.isAttrMap()) {
+        hash = node.getAttrMap().size();
+        for (size_t i = 0; i < node.getAttrMap().size(); ++i) {
+            optional<size_t> valHash = hashStructurally(node.getAttrMap().vals[i], typeTable);
+            if (!valHash.has_value()) return nullopt;
+            hash = leNiceHasheFunctione(leNiceHasheFunctione(hash.value(), node.getAttrMap().names[i].id), valHash.value());
+        }
+    }
+    if (!hash.has_value()) return nullopt;
+
+    if (node.hasTypeAttr()) {
+        optional<size_t> attrHash = hashStructurally(node.getTypeAttr(), typeTable);
+        if (!attrHash.has_value()) return nullopt;
+        hash = leNiceHasheFunctione(hash.value(), attrHash.value());
+    }
+    if (node.hasNonTypeAttrs()) {
+        optional<size_t> attrHash = hashStructurally(node.getNonTypeAttrs(), typeTable);
+        if (!attrHash.has_value()) return nullopt;
+        hash = leNiceHasheFunctione(hash.value(), attrHash.value());
+    }
+
+    return hash;
+}
+
+bool NodeVal::equalStructurally(const NodeVal &l, const NodeVal &r, const TypeTable *typeTable) {
+    if (l.isEvalVal() != r.isEvalVal() || l.isAttrMap() != r.isAttrMap()) return false;
+
+    if (l.isEvalVal()) {
+        if (!EvalVal::equalStructurally(l.getEvalVal(), r.getEvalVal(), typeTable)) return false;
+    } else if (l.isAttrMap()) {
+        if (l.getAttrMap().names != r.getAttrMap().names) return false;
+        for (size_t i = 0; i < l.getAttrMap().size(); ++i) {
+            if (!equalStructurally(l.getAttrMap().vals[i], r.getAttrMap().vals[i], typeTable)) return false;
+        }
+    } else {
+        return false;
+    }
+
+    if (l.hasTypeAttr() != r.hasTypeAttr() || l.hasNonTypeAttrs() != r.hasNonTypeAttrs()) return false;
+    if (l.hasTypeAttr() && !equalStructurally(l.getTypeAttr(), r.getTypeAttr(), typeTable)) return false;
+    if (l.hasNonTypeAttrs() && !equalStructurally(l.getNonTypeAttrs(), r.getNonTypeAttrs(), typeTable)) return false;
+
+    return true;
+}
+
 NodeVal NodeVal::copyNoRef(const NodeVal &k) {
     NodeVal nodeVal(k);
     nodeVal.removeRef();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -14,13 +15,19 @@
 #include "UndecidedCallableVal.h"
 
 class NodeVal {
+    struct Attrs;
+
     CodeLoc codeLoc;
+    std::uint32_t holeFreeId = 0;
 
     std::variant<bool, StringPool::Id, LiteralVal, SpecialVal, AttrMap, LlvmVal, EvalVal, UndecidedCallableVal> value;
-    std::unique_ptr<NodeVal> typeAttr, nonTypeAttrs;
+    // most nodes have no attributes, so both kinds share one allocation
+    std::unique_ptr<Attrs> attrs;
 
     void copyFrom(const NodeVal &other);
 
+    static bool isHoleFreeIn(const NodeVal &node, const NodeVal &child, const TypeTable *typeTable);
+
 public:
     // Invalid node
     NodeVal();
@@ -44,6 +51,14 @@ public:
     CodeLoc getCodeLoc() const { return codeLoc; }
     void setCodeLoc(CodeLoc loc) { codeLoc = loc; }
 
+    // non-zero if this non-leaf has no descendants with attributes or escaped less than itself
+    // assigned by the parser, so that quoting it promotes the same children every time
+    // conservatively zero for other nodes, and reset when children get added or unescaped totally
+    std::uint32_t getHoleFreeId() const { return holeFreeId; }
+    bool isHoleFree() const { return holeFreeId != 0; }
+    // gives the node the id after lastHoleFreeId, if it is hole-free
+    static void updateHoleFree(NodeVal &node, const TypeTable *typeTable, std::uint32_t &lastHoleFreeId);
+
     bool isEscaped() const;
     EscapeScore getEscapeScore() const;
     std::optional<TypeTable::Id> getType() const;
@@ -94,17 +109,17 @@ public:
     UndecidedCallableVal& getUndecidedCallableVal() { return std::get<UndecidedCallableVal>(value); }
     const UndecidedCallableVal& getUndecidedCallableVal() const { return std::get<UndecidedCallableVal>(value); }
 
-    bool hasTypeAttr() const { return typeAttr != nullptr; }
-    NodeVal& getTypeAttr() { return *typeAttr; }
-    const NodeVal& getTypeAttr() const { return *typeAttr; }
+    bool hasTypeAttr() const;
+    NodeVal& getTypeAttr();
+    const NodeVal& getTypeAttr() const;
     void setTypeAttr(NodeVal t);
-    void clearTypeAttr() { typeAttr.reset(); }
+    void clearTypeAttr();
 
-    bool hasNonTypeAttrs() const { return nonTypeAttrs != nullptr; }
-    NodeVal& getNonTypeAttrs() { return *nonTypeAttrs; }
-    const NodeVal& getNonTypeAttrs() const { return *nonTypeAttrs; }
+    bool hasNonTypeAttrs() const;
+    NodeVal& getNonTypeAttrs();
+    const NodeVal& getNonTypeAttrs() const;
     void setNonTypeAttrs(NodeVal a);
-    void clearNonTypeAttrs() { nonTypeAttrs.reset(); }
+    void clearNonTypeAttrs();
 
     static bool isEmpty(const NodeVal &node, const TypeTable *typeTable);
     static bool isLeaf(const NodeVal &node, const TypeTable *typeTable);
@@ -119,6 +134,12 @@ public:
 
     static NodeVal makeEmpty(CodeLoc codeLoc, TypeTable *typeTable);
 
+    // compares evaluated values and their attributes, ignoring code locs and refs
+    // nullopt if node can't be hashed this way
+    static std::optional<std::size_t> hashStructurally(const NodeVal &node, const TypeTable *typeTable);
+    // only meaningful on nodes that can be hashed
+    static bool equalStructurally(const NodeVal &l, const NodeVal &r, const TypeTable *typeTable);
+
     // TODO remove as many calls to copyNoRef as possible
     static NodeVal copyNoRef(const NodeVal &k);
     static NodeVal copyNoRef(const NodeVal &k, LifetimeInfo lifetimeInfo);
@@ -127,4 +148,16 @@ public:
     static NodeVal moveNoRef(NodeVal &&k, LifetimeInfo lifetimeInfo);
     static NodeVal moveNoRef(CodeLoc codeLoc, NodeVal &&k, LifetimeInfo lifetimeInfo);
     static void copyNonValFieldsLeaf(NodeVal &dst, const NodeVal &src, const TypeTable *typeTable);
-};
\ No newline at end of file
+};
+
+struct NodeVal::Attrs {
+    std::optional<NodeVal> type, nonType;
+};
+
+inline bool NodeVal::hasTypeAttr() const { return attrs != nullptr && attrs->type.has_value(); }
+inline NodeVal& NodeVal::getTypeAttr() { return attrs->type.value(); }
+inline const NodeVal& NodeVal::getTypeAttr() const { return attrs->type.value(); }
+
+inline bool NodeVal::hasNonTypeAttrs() const { return attrs != nullptr && attrs->nonType.has_value(); }
+inline NodeVal& NodeVal::getNonTypeAttrs() { return attrs->nonType.value(); }
+inline const NodeVal& NodeVal::getNonTypeAttrs() const { return attrs->nonType.value(); }
\ No newline at end of file
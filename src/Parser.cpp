@@ -162,6 +162,7 @@ NodeVal Parser::parseNode(bool ignoreAttrs) {
 
                     NodeVal tuple = NodeVal::makeEmpty(codeLoc, typeTable);
                     NodeVal::addChildren(tuple, move(children), typeTable); // children is emptied here
+                    NodeVal::updateHoleFree(tuple, typeTable, lastHoleFreeId);
                     NodeVal::addChild(node, move(tuple), typeTable);
                 }
             } else {
@@ -210,6 +211,7 @@ NodeVal Parser::parseNode(bool ignoreAttrs) {
         parseNonTypeAttrs(node);
     }
 
+    NodeVal::updateHoleFree(node, typeTable, lastHoleFreeId);
     NodeVal::escape(node, typeTable, escapeScore);
 
     return node;
@@ -10,6 +10,7 @@ class Parser {
     Lexer *lex;
     TypeTable *typeTable;
     CompilationMessages *msgs;
+    std::uint32_t lastHoleFreeId = 0;
 
     const Token& peek() const;
     std::pair<CodeLoc, Token> next();
@@ -9,15 +9,25 @@ Processor::Processor(NamePool *namePool, StringPool *stringPool, TypeTable *type
 }
 
 NodeVal Processor::processNode(const NodeVal &node, bool topmost) {
+    if (this == evaluator && !evaluator->countStep(node.getCodeLoc())) return NodeVal();
+
     NodeVal ret;
     if (node.hasTypeAttr() || node.hasNonTypeAttrs()) {
         bool nonIdLiteral = node.isLiteralVal() && node.getLiteralVal().kind != LiteralVal::Kind::kId;
 
-        NodeVal procAttrs = node;
+        // non-leaves don't look at their own attributes, so only those get copied, not the whole subtree
+        NodeVal procAttrs;
+        if (NodeVal::isLeaf(node, typeTable)) {
+            procAttrs = node;
+        } else {
+            procAttrs = NodeVal(node.getCodeLoc());
+            if (node.hasTypeAttr()) procAttrs.setTypeAttr(node.getTypeAttr());
+            if (node.hasNonTypeAttrs()) procAttrs.setNonTypeAttrs(node.getNonTypeAttrs());
+        }
         if (!processAttributes(procAttrs, nonIdLiteral)) return NodeVal();
 
-        if (NodeVal::isLeaf(procAttrs, typeTable)) ret = processLeaf(procAttrs);
-        else ret = processNonLeaf(procAttrs, topmost);
+        if (NodeVal::isLeaf(node, typeTable)) ret = processLeaf(procAttrs);
+        else ret = processNonLeaf(node, topmost);
         if (ret.isInvalid()) return NodeVal();
 
         if (procAttrs.hasTypeAttr()) ret.setTypeAttr(move(procAttrs.getTypeAttr()));
@@ -92,6 +102,10 @@ NodeVal Processor::processNonLeaf(const NodeVal &node, bool topmost) {
                 return processLoop(node);
             case Keyword::PASS:
                 return processPass(node);
+            case Keyword::BRANCH:
+                return processBranch(node);
+            case Keyword::ATOMIC:
+                return processAtomic(node, starting);
             case Keyword::EXPLICIT:
                 return processExplicit(node, starting);
             case Keyword::DATA:
@@ -142,10 +156,13 @@ NodeVal Processor::processNonLeaf(const NodeVal &node, bool topmost) {
 }
 
 NodeVal Processor::processNonLeafEscaped(const NodeVal &node) {
+    if (node.isHoleFree()) return processNonLeafEscapedHoleFree(node);
+
     NodeVal nodeValRaw = NodeVal::makeEmpty(node.getCodeLoc(), typeTable);
     NodeVal::copyNonValFieldsLeaf(nodeValRaw, node, typeTable);
     NodeVal::unescape(nodeValRaw, typeTable);
 
+    nodeValRaw.getEvalVal().elems().reserve(node.getChildrenCnt());
     for (const auto &it : node.getEvalVal().elems()) {
         NodeVal childProc = processNode(it);
         if (childProc.isInvalid()) return NodeVal();
@@ -161,6 +178,43 @@ NodeVal Processor::processNonLeafEscaped(const NodeVal &node) {
     return nodeValRaw;
 }
 
+NodeVal Processor::processNonLeafEscapedHoleFree(const NodeVal &node) {
+    // nothing in here gets evaluated, so children only get promoted and unescaped
+    // that depends only on the parsed node and how much it is escaped, so it's done once and then copied
+    auto loc = holeFreeElems.find(node.getHoleFreeId());
+    if (loc == holeFreeElems.end() || loc->second.first != node.getEscapeScore()) {
+        NodeVal promoted = promoteHoleFree(node);
+        if (promoted.isInvalid()) return NodeVal();
+
+        loc = holeFreeElems.insert_or_assign(node.getHoleFreeId(), make_pair(node.getEscapeScore(), move(promoted.getEvalVal().elems()))).first;
+    }
+
+    NodeVal nodeValRaw = NodeVal::makeEmpty(node.getCodeLoc(), typeTable);
+    NodeVal::copyNonValFieldsLeaf(nodeValRaw, node, typeTable);
+    NodeVal::unescape(nodeValRaw, typeTable);
+
+    // parsed nodes are never cn, so the children can be placed directly
+    nodeValRaw.getEvalVal().elems() = loc->second.second;
+
+    return nodeValRaw;
+}
+
+NodeVal Processor::promoteHoleFree(const NodeVal &node) {
+    NodeVal nodeValRaw = NodeVal::makeEmpty(node.getCodeLoc(), typeTable);
+    NodeVal::copyNonValFieldsLeaf(nodeValRaw, node, typeTable);
+    NodeVal::unescape(nodeValRaw, typeTable);
+
+    vector<NodeVal> &elems = nodeValRaw.getEvalVal().elems();
+    elems.reserve(node.getChildrenCnt());
+    for (const auto &it : node.getEvalVal().elems()) {
+        if (NodeVal::isLeaf(it, typeTable)) elems.push_back(processLeaf(it));
+        else elems.push_back(promoteHoleFree(it));
+        if (elems.back().isInvalid()) return NodeVal();
+    }
+
+    return nodeValRaw;
+}
+
 NodeVal Processor::processType(const NodeVal &node, const NodeVal &starting) {
     if (checkExactlyChildren(node, 1, false))
         return NodeVal::copyNoRef(node.getCodeLoc(), starting, LifetimeInfo());
@@ -262,9 +316,21 @@ NodeVal Processor::processSym(const NodeVal &node) {
             optType = pair.second.value().getEvalVal().ty();
             if (!checkIsNotUndefType(pair.second.value().getCodeLoc(), optType.value(), true)) return NodeVal();
         }
-        optional<bool> attrEvaluated = getAttributeForBool(pair.first, "evaluated");
+        optional<bool> attrEvaluated = getAttributeForBool(pair.first, Attr::EVALUATED);
         if (!attrEvaluated.has_value()) return NodeVal();
 
+        SymAttrs symAttrs;
+        optional<bool> attrThreadLocal = getAttributeForBool(pair.first, Attr::THREAD_LOCAL);
+        if (!attrThreadLocal.has_value()) return NodeVal();
+        if (attrThreadLocal.value() && (attrEvaluated.value() || !checkInGlobalScope(pair.first.getCodeLoc(), false))) {
+            msgs->errorSymThreadLocalNotGlobal(pair.first.getCodeLoc(), id);
+            return NodeVal();
+        }
+        symAttrs.threadLocal = attrThreadLocal.value();
+        optional<optional<uint64_t>> attrAlign = getAlignment(pair.first);
+        if (!attrAlign.has_value()) return NodeVal();
+        symAttrs.align = attrAlign.value();
+
         bool hasType = optType.has_value();
 
         TypeTable::Id varType;
@@ -283,8 +349,8 @@ NodeVal Processor::processSym(const NodeVal &node) {
             varType = init.getType().value();
 
             NodeVal reg;
-            if (attrEvaluated.value()) reg = evaluator->performRegister(pair.first.getCodeLoc(), id, move(init));
-            else reg = performRegister(pair.first.getCodeLoc(), id, move(init));
+            if (attrEvaluated.value()) reg = evaluator->performRegister(pair.first.getCodeLoc(), id, move(init), symAttrs);
+            else reg = performRegister(pair.first.getCodeLoc(), id, move(init), symAttrs);
             if (reg.isInvalid()) return NodeVal();
 
             varEntry.var = move(reg);
@@ -300,13 +366,13 @@ NodeVal Processor::processSym(const NodeVal &node) {
 
             varType = optType.value();
 
-            optional<bool> attrNoZero = getAttributeForBool(pair.first, "noZero");
+            optional<bool> attrNoZero = getAttributeForBool(pair.first, Attr::NO_ZERO);
             if (!attrNoZero.has_value()) return NodeVal();
 
             NodeVal nodeReg;
             if (attrNoZero.value()) {
-                if (attrEvaluated.value()) nodeReg = evaluator->performRegister(pair.first.getCodeLoc(), id, pair.second.value().getCodeLoc(), optType.value());
-                else nodeReg = performRegister(pair.first.getCodeLoc(), id, pair.second.value().getCodeLoc(), optType.value());
+                if (attrEvaluated.value()) nodeReg = evaluator->performRegister(pair.first.getCodeLoc(), id, pair.second.value().getCodeLoc(), optType.value(), symAttrs);
+                else nodeReg = performRegister(pair.first.getCodeLoc(), id, pair.second.value().getCodeLoc(), optType.value(), symAttrs);
                 if (nodeReg.isInvalid()) return NodeVal();
             } else {
                 NodeVal nodeZero;
@@ -314,8 +380,8 @@ NodeVal Processor::processSym(const NodeVal &node) {
                 else nodeZero = performZero(pair.second.value().getCodeLoc(), optType.value());
                 if (nodeZero.isInvalid()) return NodeVal();
 
-                if (attrEvaluated.value()) nodeReg = evaluator->performRegister(pair.first.getCodeLoc(), id, move(nodeZero));
-                else nodeReg = performRegister(pair.first.getCodeLoc(), id, move(nodeZero));
+                if (attrEvaluated.value()) nodeReg = evaluator->performRegister(pair.first.getCodeLoc(), id, move(nodeZero), symAttrs);
+                else nodeReg = performRegister(pair.first.getCodeLoc(), id, move(nodeZero), symAttrs);
                 if (nodeReg.isInvalid()) return NodeVal();
             }
 
@@ -356,9 +422,16 @@ NodeVal Processor::processCast(const NodeVal &node) {
 NodeVal Processor::processBlock(const NodeVal &node, const NodeVal &starting) {
     if (!checkBetweenChildren(node, 2, 4, true)) return NodeVal();
 
-    optional<bool> attrBare = getAttributeForBool(starting, "bare");
+    optional<bool> attrBare = getAttributeForBool(starting, Attr::BARE);
     if (!attrBare.has_value()) return NodeVal();
 
+    optional<SymbolTable::LoopHints> loopHints = getLoopHints(starting);
+    if (!loopHints.has_value()) return NodeVal();
+    if (attrBare.value() && !loopHints.value().isEmpty()) {
+        msgs->errorBlockBareLoopHints(starting.getNonTypeAttrs().getCodeLoc());
+        return NodeVal();
+    }
+
     bool hasName = node.getChildrenCnt() > 3;
     bool hasType = node.getChildrenCnt() > 2;
 
@@ -418,23 +491,157 @@ NodeVal Processor::processBlock(const NodeVal &node, const NodeVal &starting) {
         SymbolTable::Block block;
         block.name = name;
         block.type = type;
-        if (!performBlockSetUp(node.getCodeLoc(), block)) return NodeVal();
+        block.loopHints = loopHints.value();
+        return processBlockNonBare(node.getCodeLoc(), block, nodeBody);
+    }
+}
 
-        do {
-            BlockRaii blockRaii(symbolTable, block);
+NodeVal Processor::processBranch(const NodeVal &node) {
+    if (!checkAtLeastChildren(node, 4, true)) return NodeVal();
 
-            optional<bool> blockSuccess = performBlockBody(node.getCodeLoc(), symbolTable->getLastBlock(), nodeBody);
-            if (!blockSuccess.has_value()) {
-                performBlockTearDown(node.getCodeLoc(), symbolTable->getLastBlock(), false);
-                return NodeVal();
+    NodeVal val = processAndCheckHasType(node.getChild(1));
+    if (val.isInvalid()) return NodeVal();
+
+    TypeTable::Id valTy = val.getType().value();
+    if (!typeTable->worksAsTypeI(valTy) && !typeTable->worksAsTypeU(valTy) && !typeTable->worksAsTypeC(valTy)) {
+        msgs->errorBranchValType(val.getCodeLoc(), valTy);
+        return NodeVal();
+    }
+
+    vector<vector<NodeVal>> caseVals;
+    vector<const NodeVal*> bodies;
+    for (size_t i = 2; i < node.getChildrenCnt(); i += 2) {
+        // default body has no case values before it
+        bool isDefault = i+1 == node.getChildrenCnt();
+
+        if (!isDefault) {
+            const NodeVal &nodeCase = node.getChild(i);
+            if (!checkIsRaw(nodeCase, true)) return NodeVal();
+
+            vector<NodeVal> vals;
+            vals.reserve(nodeCase.getChildrenCnt());
+            for (size_t j = 0; j < nodeCase.getChildrenCnt(); ++j) {
+                NodeVal caseVal = processAndImplicitCast(nodeCase.getChild(j), valTy);
+                if (caseVal.isInvalid()) return NodeVal();
+                vals.push_back(move(caseVal));
             }
+            caseVals.push_back(move(vals));
+        }
+
+        const NodeVal &nodeBody = node.getChild(isDefault ? i : i+1);
+        if (!checkIsRaw(nodeBody, true)) return NodeVal();
+        bodies.push_back(&nodeBody);
+    }
+
+    if (!performBranch(node.getCodeLoc(), val, caseVals, bodies)) return NodeVal();
+
+    return NodeVal(node.getCodeLoc());
+}
 
-            if (blockSuccess.value()) continue;
+NodeVal Processor::processAtomic(const NodeVal &node, const NodeVal &starting) {
+    if (!checkAtLeastChildren(node, 2, true)) return NodeVal();
+
+    NodeVal nodeOp = processForIdValue(node.getChild(1));
+    if (nodeOp.isInvalid()) return NodeVal();
+
+    optional<AtomicOp> op = getAtomicOp(nodeOp.getEvalVal().id());
+    if (!op.has_value()) {
+        msgs->errorAtomicUnknownOp(nodeOp.getCodeLoc(), nodeOp.getEvalVal().id());
+        return NodeVal();
+    }
+
+    static const vector<pair<Attr, AtomicOrdering>> orderingAttrs = {
+        {Attr::RELAXED, AtomicOrdering::RELAXED},
+        {Attr::ACQUIRE, AtomicOrdering::ACQUIRE},
+        {Attr::RELEASE, AtomicOrdering::RELEASE},
+        {Attr::ACQ_REL, AtomicOrdering::ACQ_REL},
+        {Attr::SEQ_CST, AtomicOrdering::SEQ_CST}
+    };
+    AtomicAttrs attrs;
+    bool hasOrdering = false;
+    for (const auto &it : orderingAttrs) {
+        optional<bool> attr = getAttributeForBool(starting, it.first);
+        if (!attr.has_value()) return NodeVal();
+        if (!attr.value()) continue;
+
+        if (hasOrdering) {
+            msgs->errorAtomicOrderingsConflict(starting.getCodeLoc());
+            return NodeVal();
+        }
+        hasOrdering = true;
+        attrs.ordering = it.second;
+    }
+
+    optional<bool> attrWeak = getAttributeForBool(starting, Attr::WEAK);
+    if (!attrWeak.has_value()) return NodeVal();
+    attrs.weak = attrWeak.value();
+
+    // same restrictions as in C++
+    bool orderingOk = true;
+    if (op == AtomicOp::LOAD) orderingOk = attrs.ordering != AtomicOrdering::RELEASE && attrs.ordering != AtomicOrdering::ACQ_REL;
+    else if (op == AtomicOp::STORE) orderingOk = attrs.ordering != AtomicOrdering::ACQUIRE && attrs.ordering != AtomicOrdering::ACQ_REL;
+    else if (op == AtomicOp::FENCE) orderingOk = attrs.ordering != AtomicOrdering::RELAXED;
+    if (!orderingOk) {
+        msgs->errorAtomicBadOrdering(starting.getCodeLoc());
+        return NodeVal();
+    }
+
+    if (op == AtomicOp::FENCE) {
+        if (!checkExactlyChildren(node, 2, true)) return NodeVal();
 
-            NodeVal ret = performBlockTearDown(node.getCodeLoc(), symbolTable->getLastBlock(), true);
-            if (ret.isInvalid()) return NodeVal();
-            return ret;
-        } while (true);
+        if (!performFence(node.getCodeLoc(), attrs)) return NodeVal();
+        return NodeVal(node.getCodeLoc());
+    }
+
+    size_t operCnt = op == AtomicOp::LOAD ? 1 : (op == AtomicOp::CMPXCHG ? 3 : 2);
+    if (!checkExactlyChildren(node, 2+operCnt, true)) return NodeVal();
+
+    NodeVal ptr = processAndCheckHasType(node.getChild(2));
+    if (ptr.isInvalid()) return NodeVal();
+
+    optional<TypeTable::Id> ty;
+    if (typeTable->worksAsTypeP(ptr.getType().value())) ty = typeTable->addTypeDerefOf(ptr.getType().value());
+
+    // pointers can't be used in arithmetic, nor exchanged in llvm
+    bool tyOk = ty.has_value() &&
+        (typeTable->worksAsTypeI(ty.value()) || typeTable->worksAsTypeU(ty.value()) || typeTable->worksAsTypeC(ty.value()) ||
+        (typeTable->worksAsTypeAnyP(ty.value()) && (op == AtomicOp::LOAD || op == AtomicOp::STORE || op == AtomicOp::CMPXCHG)));
+    if (!tyOk) {
+        msgs->errorAtomicBadType(ptr.getCodeLoc(), ptr.getType().value());
+        return NodeVal();
+    }
+    if (op != AtomicOp::LOAD && typeTable->worksAsTypeCn(ty.value())) {
+        msgs->errorExprAsgnOnCn(ptr.getCodeLoc());
+        return NodeVal();
+    }
+
+    bool allEval = checkIsEvalTime(ptr, false);
+    vector<NodeVal> opers;
+    for (size_t i = 3; i < node.getChildrenCnt(); ++i) {
+        NodeVal oper = processAndImplicitCast(node.getChild(i), ty.value());
+        if (oper.isInvalid()) return NodeVal();
+        if (!checkIsEvalTime(oper, false)) allEval = false;
+        opers.push_back(move(oper));
+    }
+
+    if (op == AtomicOp::LOAD) {
+        if (allEval) return evaluator->performAtomicLoad(node.getCodeLoc(), ptr, ty.value(), attrs);
+        else return performAtomicLoad(node.getCodeLoc(), ptr, ty.value(), attrs);
+    } else if (op == AtomicOp::STORE) {
+        bool success;
+        if (allEval) success = evaluator->performAtomicStore(node.getCodeLoc(), ptr, opers[0], attrs);
+        else success = performAtomicStore(node.getCodeLoc(), ptr, opers[0], attrs);
+        if (!success) return NodeVal();
+        return NodeVal(node.getCodeLoc());
+    } else if (op == AtomicOp::CMPXCHG) {
+        TypeTable::Tuple tup({ty.value(), typeTable->getPrimTypeId(TypeTable::P_BOOL)});
+        TypeTable::Id resTy = typeTable->addTuple(tup).value();
+
+        if (allEval) return evaluator->performAtomicCmpXchg(node.getCodeLoc(), ptr, opers[0], opers[1], resTy, attrs);
+        else return performAtomicCmpXchg(node.getCodeLoc(), ptr, opers[0], opers[1], resTy, attrs);
+    } else {
+        if (allEval) return evaluator->performAtomicRmw(node.getCodeLoc(), ptr, opers[0], op.value(), ty.value(), attrs);
+        else return performAtomicRmw(node.getCodeLoc(), ptr, opers[0], op.value(), ty.value(), attrs);
     }
 }
 
@@ -477,7 +684,10 @@ NodeVal Processor::processExit(const NodeVal &node) {
     if (nodeCond.isInvalid()) return NodeVal();
     if (!checkIsBool(nodeCond, true)) return NodeVal();
 
-    if (!performExit(node.getCodeLoc(), targetBlock, nodeCond)) return NodeVal();
+    optional<optional<bool>> likely = getLikelihood(nodeCond);
+    if (!likely.has_value()) return NodeVal();
+
+    if (!performExit(node.getCodeLoc(), targetBlock, nodeCond, likely.value())) return NodeVal();
     return NodeVal(node.getCodeLoc());
 }
 
@@ -516,7 +726,10 @@ NodeVal Processor::processLoop(const NodeVal &node) {
     if (nodeCond.isInvalid()) return NodeVal();
     if (!checkIsBool(nodeCond, true)) return NodeVal();
 
-    if (!performLoop(node.getCodeLoc(), targetBlock, nodeCond)) return NodeVal();
+    optional<optional<bool>> likely = getLikelihood(nodeCond);
+    if (!likely.has_value()) return NodeVal();
+
+    if (!performLoop(node.getCodeLoc(), targetBlock, nodeCond, likely.value())) return NodeVal();
     return NodeVal(node.getCodeLoc());
 }
 
@@ -570,7 +783,7 @@ NodeVal Processor::processPass(const NodeVal &node) {
 NodeVal Processor::processExplicit(const NodeVal &node, const NodeVal &starting) {
     if (!checkExactlyChildren(node, 3, true)) return NodeVal();
 
-    optional<bool> attrGlobal = getAttributeForBool(starting, "global");
+    optional<bool> attrGlobal = getAttributeForBool(starting, Attr::GLOBAL);
     if (!attrGlobal.has_value()) return NodeVal();
 
     if (!attrGlobal.value() && !checkInGlobalScope(starting.getCodeLoc(), true)) {
@@ -607,7 +820,7 @@ NodeVal Processor::processExplicit(const NodeVal &node, const NodeVal &starting)
 NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
     if (!checkBetweenChildren(node, 2, 4, true)) return NodeVal();
 
-    optional<bool> attrGlobal = getAttributeForBool(starting, "global");
+    optional<bool> attrGlobal = getAttributeForBool(starting, Attr::GLOBAL);
     if (!attrGlobal.has_value()) return NodeVal();
 
     if (!attrGlobal.value() && !checkInGlobalScope(starting.getCodeLoc(), true)) {
@@ -622,6 +835,12 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
     size_t indElems = definition ? 2 : 0;
     size_t indDrop = withDrop ? 3 : 0;
 
+    optional<bool> attrPacked = getAttributeForBool(starting, Attr::PACKED);
+    if (!attrPacked.has_value()) return NodeVal();
+
+    optional<optional<uint64_t>> attrAlign = getAlignment(starting);
+    if (!attrAlign.has_value()) return NodeVal();
+
     TypeTable::DataType dataType;
     dataType.defined = false;
 
@@ -647,6 +866,9 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
 
     dataType.defined = definition;
     if (dataType.defined) {
+        dataType.packed = attrPacked.value();
+        dataType.align = attrAlign.value();
+
         NodeVal nodeElems = processWithEscape(node.getChild(indElems));
         if (nodeElems.isInvalid()) return NodeVal();
         if (!checkIsRaw(nodeElems, true)) return NodeVal();
@@ -672,7 +894,7 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
             }
             if (!checkIsNotUndefType(elem.second.value().getCodeLoc(), elemType, true)) return NodeVal();
 
-            optional<bool> attrNoZero = getAttributeForBool(elem.first, "noZero");
+            optional<bool> attrNoZero = getAttributeForBool(elem.first, Attr::NO_ZERO);
             if (!attrNoZero.has_value()) return NodeVal();
 
             TypeTable::DataType::ElemEntry elemEntry;
@@ -689,7 +911,7 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
             return NodeVal();
         }
 
-        if (nodeElems.hasNonTypeAttrs() && !nodeElems.getNonTypeAttrs().getAttrMap().attrMap.empty()) {
+        if (nodeElems.hasNonTypeAttrs() && !nodeElems.getNonTypeAttrs().getAttrMap().empty()) {
             symbolTable->registerDataAttrs(typeIdOpt.value(), move(nodeElems.getNonTypeAttrs().getAttrMap()));
         }
 
@@ -712,6 +934,13 @@ NodeVal Processor::processData(const NodeVal &node, const NodeVal &starting) {
 }
 
 NodeVal Processor::processCall(const NodeVal &node, const NodeVal &starting) {
+    // processing args may start other calls, so this is checked first
+    bool tailCallCand = false;
+    if (this == evaluator) {
+        tailCallCand = evaluator->tailCallCand == &node;
+        evaluator->tailCallCand = nullptr;
+    }
+
     size_t providedArgCnt = node.getChildrenCnt()-1;
 
     vector<NodeVal> args;
@@ -784,6 +1013,8 @@ NodeVal Processor::processCall(const NodeVal &node, const NodeVal &starting) {
 
         if (!implicitCastArgsAndVerifyCallOk(node.getCodeLoc(), args, callable)) return NodeVal();
 
+        if (tailCallCand && allArgsEval) evaluator->tryTailCall(node.getCodeLoc(), starting.getCodeLoc(), funcId.value(), args);
+
         ret = dispatchCall(node.getCodeLoc(), starting.getCodeLoc(), funcId.value(), args, allArgsEval);
     } else {
         if (!starting.getType().has_value()) {
@@ -804,6 +1035,8 @@ NodeVal Processor::processCall(const NodeVal &node, const NodeVal &starting) {
 
         if (!implicitCastArgsAndVerifyCallOk(node.getCodeLoc(), args, callable)) return NodeVal();
 
+        if (tailCallCand && allArgsEval) evaluator->tryTailCall(node.getCodeLoc(), starting.getCodeLoc(), starting, args);
+
         ret = dispatchCall(node.getCodeLoc(), starting.getCodeLoc(), starting, args, allArgsEval);
     }
 
@@ -893,7 +1126,7 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
 
     // fnc
     {
-        optional<bool> attrGlobal = getAttributeForBool(starting, "global");
+        optional<bool> attrGlobal = getAttributeForBool(starting, Attr::GLOBAL);
         if (!attrGlobal.has_value()) return NodeVal();
 
         if (!attrGlobal.value() && !checkInGlobalScope(starting.getCodeLoc(), true)) {
@@ -908,6 +1141,8 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
     bool noNameMangle;
     bool isMain;
     bool evaluable, compilable;
+    bool memoize;
+    FuncValue::Hints hints;
     {
         NodeVal nodeName = processForIdValue(node.getChild(indName));
         if (nodeName.isInvalid()) return NodeVal();
@@ -919,16 +1154,16 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
             return NodeVal();
         }
 
-        optional<bool> attrNoNameMangle = getAttributeForBool(nodeName, "noNameMangle");
+        optional<bool> attrNoNameMangle = getAttributeForBool(nodeName, Attr::NO_NAME_MANGLE);
         if (!attrNoNameMangle.has_value()) return NodeVal();
         isMain = isMeaningful(name, Meaningful::MAIN);
         noNameMangle = attrNoNameMangle.value();
 
-        optional<bool> attrEvaluableOpt = getAttributeForBool(nodeName, "evaluable", this == evaluator);
+        optional<bool> attrEvaluableOpt = getAttributeForBool(nodeName, Attr::EVALUABLE, this == evaluator);
         if (!attrEvaluableOpt.has_value()) return NodeVal();
         evaluable = attrEvaluableOpt.value();
 
-        optional<bool> attrCompilableOpt = getAttributeForBool(nodeName, "compilable", this == compiler);
+        optional<bool> attrCompilableOpt = getAttributeForBool(nodeName, Attr::COMPILABLE, this == compiler);
         if (!attrCompilableOpt.has_value()) return NodeVal();
         compilable = attrCompilableOpt.value();
 
@@ -937,19 +1172,56 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
             msgs->errorFuncNotEvalOrCompiled(codeLoc);
             return NodeVal();
         }
+
+        optional<bool> attrInline = getAttributeForBool(nodeName, Attr::INLINE);
+        if (!attrInline.has_value()) return NodeVal();
+        optional<bool> attrNoInline = getAttributeForBool(nodeName, Attr::NO_INLINE);
+        if (!attrNoInline.has_value()) return NodeVal();
+        optional<bool> attrFlatten = getAttributeForBool(nodeName, Attr::FLATTEN);
+        if (!attrFlatten.has_value()) return NodeVal();
+        optional<bool> attrHot = getAttributeForBool(nodeName, Attr::HOT);
+        if (!attrHot.has_value()) return NodeVal();
+        optional<bool> attrCold = getAttributeForBool(nodeName, Attr::COLD);
+        if (!attrCold.has_value()) return NodeVal();
+        optional<bool> attrPure = getAttributeForBool(nodeName, Attr::PURE);
+        if (!attrPure.has_value()) return NodeVal();
+        optional<bool> attrNoReturn = getAttributeForBool(nodeName, Attr::NO_RETURN);
+        if (!attrNoReturn.has_value()) return NodeVal();
+        optional<bool> attrMemoize = getAttributeForBool(nodeName, Attr::MEMOIZE);
+        if (!attrMemoize.has_value()) return NodeVal();
+
+        if (attrInline.value() && attrNoInline.value()) {
+            msgs->errorFuncAttrsConflict(nodeName.getNonTypeAttrs().getCodeLoc(), "inline", "noInline");
+            return NodeVal();
+        }
+        if (attrHot.value() && attrCold.value()) {
+            msgs->errorFuncAttrsConflict(nodeName.getNonTypeAttrs().getCodeLoc(), "hot", "cold");
+            return NodeVal();
+        }
+
+        hints.inline_ = attrInline.value();
+        hints.noInline = attrNoInline.value();
+        hints.flatten = attrFlatten.value();
+        hints.hot = attrHot.value();
+        hints.cold = attrCold.value();
+        hints.pure = attrPure.value();
+        hints.noReturn = attrNoReturn.value();
+        memoize = attrMemoize.value();
     }
 
     // arguments
     vector<NamePool::Id> argNames;
     vector<TypeTable::Id> argTypes;
     vector<bool> argNoDrops;
+    vector<bool> argNoAliases;
     const NodeVal &nodeArgs = processWithEscape(node.getChild(indArgs));
     if (nodeArgs.isInvalid()) return NodeVal();
     if (!checkIsRaw(nodeArgs, true)) return NodeVal();
     argNames.reserve(nodeArgs.getChildrenCnt());
     argTypes.reserve(nodeArgs.getChildrenCnt());
     argNoDrops.reserve(nodeArgs.getChildrenCnt());
-    optional<bool> variadic = getAttributeForBool(nodeArgs, "variadic");
+    argNoAliases.reserve(nodeArgs.getChildrenCnt());
+    optional<bool> variadic = getAttributeForBool(nodeArgs, Attr::VARIADIC);
     if (!variadic.has_value()) return NodeVal();
     for (size_t i = 0; i < nodeArgs.getChildrenCnt(); ++i) {
         const NodeVal &nodeArg = nodeArgs.getChild(i);
@@ -967,12 +1239,26 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
         TypeTable::Id argTy = arg.second.value().getEvalVal().ty();
         if (isDef && !checkIsNotUndefType(arg.second.value().getCodeLoc(), argTy, true)) return NodeVal();
 
-        optional<bool> attrNoDrop = getAttributeForBool(arg.first, "noDrop");
+        optional<bool> attrNoDrop = getAttributeForBool(arg.first, Attr::NO_DROP);
         if (!attrNoDrop.has_value()) return NodeVal();
 
+        optional<bool> attrNoAlias = getAttributeForBool(arg.first, Attr::NO_ALIAS);
+        if (!attrNoAlias.has_value()) return NodeVal();
+        if (attrNoAlias.value() && !typeTable->worksAsTypeAnyP(argTy)) {
+            msgs->errorNoAliasNonPointer(arg.first.getNonTypeAttrs().getCodeLoc(), argTy);
+            return NodeVal();
+        }
+
+        // memoized results are copied out on hits, so owned values would be duplicated
+        if (memoize && !hasTrivialDrop(argTy)) {
+            msgs->errorMemoizeOwning(arg.second.value().getCodeLoc(), argTy);
+            return NodeVal();
+        }
+
         argNames.push_back(argId);
         argTypes.push_back(argTy);
         argNoDrops.push_back(attrNoDrop.value());
+        argNoAliases.push_back(attrNoAlias.value());
     }
 
     // check no arg name duplicates
@@ -994,6 +1280,10 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
 
             retType = ty.getEvalVal().ty();
             if (isDef && !checkIsNotUndefType(nodeRetType.getCodeLoc(), retType.value(), true)) return NodeVal();
+            if (memoize && !hasTrivialDrop(retType.value())) {
+                msgs->errorMemoizeOwning(nodeRetType.getCodeLoc(), retType.value());
+                return NodeVal();
+            }
         }
     }
 
@@ -1024,7 +1314,10 @@ NodeVal Processor::processFnc(const NodeVal &node, const NodeVal &starting) {
     BaseCallableValue::setType(funcVal, type, typeTable);
     funcVal.name = name;
     funcVal.argNames = argNames;
+    funcVal.argNoAliases = argNoAliases;
     funcVal.noNameMangle = noNameMangle || isMain || variadic.value();
+    funcVal.hints = hints;
+    funcVal.memoize = memoize;
     funcVal.defined = isDef;
 
     // register only if first func of its name
@@ -1103,7 +1396,7 @@ NodeVal Processor::processMac(const NodeVal &node, const NodeVal &starting) {
 
     // mac
     {
-        optional<bool> attrGlobal = getAttributeForBool(starting, "global");
+        optional<bool> attrGlobal = getAttributeForBool(starting, Attr::GLOBAL);
         if (!attrGlobal.has_value()) return NodeVal();
 
         if (!attrGlobal.value() && !checkInGlobalScope(starting.getCodeLoc(), true)) {
@@ -1151,9 +1444,9 @@ NodeVal Processor::processMac(const NodeVal &node, const NodeVal &starting) {
         NamePool::Id argId = arg.getEvalVal().id();
         argNames.push_back(argId);
 
-        optional<bool> isPreproc = getAttributeForBool(arg, "preprocess");
+        optional<bool> isPreproc = getAttributeForBool(arg, Attr::PREPROCESS);
         if (!isPreproc.has_value()) return NodeVal();
-        optional<bool> isPlusEsc = getAttributeForBool(arg, "plusEscape");
+        optional<bool> isPlusEsc = getAttributeForBool(arg, Attr::PLUS_ESCAPE);
         if (!isPlusEsc.has_value()) return NodeVal();
         if (isPreproc.value() && isPlusEsc.value()) {
             msgs->errorMacroArgPreprocessAndPlusEscape(arg.getNonTypeAttrs().getCodeLoc());
@@ -1163,7 +1456,7 @@ NodeVal Processor::processMac(const NodeVal &node, const NodeVal &starting) {
         else if (isPlusEsc.value()) argPreHandling.push_back(MacroValue::PLUS_ESC);
         else argPreHandling.push_back(MacroValue::REGULAR);
 
-        optional<bool> isVariadic = getAttributeForBool(arg, "variadic");
+        optional<bool> isVariadic = getAttributeForBool(arg, Attr::VARIADIC);
         if (!isVariadic.has_value()) return NodeVal();
         variadic = isVariadic.value();
     }
@@ -1263,7 +1556,12 @@ NodeVal Processor::processRet(const NodeVal &node) {
                 return NodeVal();
             }
 
+            // a call made here by an evaluated function may replace it
+            // evaluable functions are also compiled, where this must not happen
+            bool tailCallOk = this == evaluator && optCallee.value().isEval;
+            if (tailCallOk) evaluator->tailCallCand = &node.getChild(1);
             NodeVal moved = processForScopeResult(node.getChild(1), true);
+            if (tailCallOk) evaluator->tailCallCand = nullptr;
             if (moved.isInvalid()) return NodeVal();
 
             NodeVal casted = implicitCast(moved, optCallee.value().retType.value());
@@ -1347,9 +1645,9 @@ NodeVal Processor::processMessage(const NodeVal &node, const NodeVal &starting)
         return NodeVal();
     }
 
-    optional<bool> attrWarning = getAttributeForBool(starting, "warning");
+    optional<bool> attrWarning = getAttributeForBool(starting, Attr::WARNING);
     if (!attrWarning.has_value()) return NodeVal();
-    optional<bool> attrError = getAttributeForBool(starting, "error");
+    optional<bool> attrError = getAttributeForBool(starting, Attr::ERROR);
     if (!attrError.has_value()) return NodeVal();
     if (attrWarning.value() && attrError.value()) {
         msgs->errorMessageMultiLevel(starting.getNonTypeAttrs().getCodeLoc());
@@ -1373,8 +1671,8 @@ NodeVal Processor::processMessage(const NodeVal &node, const NodeVal &starting)
     CodeLoc codeLoc = node.getCodeLoc();
     size_t indPrintStart = 0;
 
-    optional<NodeVal> attrLoc = getAttribute(opers.front(), "loc");
-    if (attrLoc.has_value()) {
+    bool attrLoc = getAttribute(opers.front(), Attr::LOC) != nullptr;
+    if (attrLoc) {
         if (!checkAtLeastChildren(node, 3, true)) return NodeVal();
 
         codeLoc = opers.front().getCodeLoc();
@@ -1418,7 +1716,7 @@ NodeVal Processor::processMessage(const NodeVal &node, const NodeVal &starting)
 
     msgs->userMessageEnd();
 
-    if (attrLoc.has_value()) {
+    if (attrLoc) {
         msgs->displayCodeSegment(codeLoc);
 
         // none of printable types can have a drop function
@@ -1472,6 +1770,14 @@ NodeVal Processor::processTypeOf(const NodeVal &node) {
 NodeVal Processor::processLenOf(const NodeVal &node) {
     if (!checkExactlyChildren(node, 2, true)) return NodeVal();
 
+    // raw vars are not loaded, as that would copy all of their elements
+    optional<VarId> rawVarId = getPlainRawVarId(node.getChild(1));
+    if (rawVarId.has_value()) {
+        EvalVal evalVal = EvalVal::makeVal(typeTable->getPrimTypeId(TypeTable::WIDEST_U), typeTable);
+        evalVal.getWidestU() = symbolTable->getVar(rawVarId.value()).var.getChildrenCnt();
+        return NodeVal(node.getCodeLoc(), move(evalVal));
+    }
+
     NodeVal operand = processNode(node.getChild(1));
     if (operand.isInvalid()) return NodeVal();
     if (!checkHasType(operand, true)) return NodeVal();
@@ -1483,6 +1789,8 @@ NodeVal Processor::processLenOf(const NodeVal &node) {
     uint64_t len;
     if (typeTable->worksAsTypeArr(ty)){
         len = typeTable->extractLenOfArr(ty).value();
+    } else if (typeTable->worksAsTypeVec(ty)) {
+        len = typeTable->extractLenOfVec(ty).value();
     } else if (typeTable->worksAsTuple(ty)) {
         len = typeTable->extractLenOfTuple(ty).value();
     } else if (typeTable->worksAsPrimitive(ty, TypeTable::P_RAW)) {
@@ -1560,15 +1868,17 @@ NodeVal Processor::processAttrOf(const NodeVal &node) {
     if (name.isInvalid()) return NodeVal();
     NamePool::Id attrName = name.getEvalVal().id();
 
-    optional<NodeVal> nodeAttr = getAttributeFull(operand, attrName);
-    if (!nodeAttr.has_value()) {
+    const NodeVal *nodeAttr = getAttributeFull(operand, attrName);
+    if (nodeAttr == nullptr) {
         msgs->errorAttributeNotFound(node.getCodeLoc(), attrName);
         return NodeVal();
     }
+    // copied before the operand gets dropped, as it may own the attribute
+    NodeVal attr = *nodeAttr;
 
     if (!callDropFuncTmpVal(move(operand))) return NodeVal();
 
-    return move(nodeAttr.value());
+    return attr;
 }
 
 NodeVal Processor::processAttrIsDef(const NodeVal &node) {
@@ -1582,68 +1892,156 @@ NodeVal Processor::processAttrIsDef(const NodeVal &node) {
     if (name.isInvalid()) return NodeVal();
     NamePool::Id attrName = name.getEvalVal().id();
 
-    bool attrIsDef = getAttributeFull(operand, attrName).has_value();
+    bool attrIsDef = getAttributeFull(operand, attrName) != nullptr;
 
     if (!callDropFuncTmpVal(move(operand))) return NodeVal();
 
     return promoteBool(node.getCodeLoc(), attrIsDef);
 }
 
-// returns nullopt if not found
+// returns nullptr if not found
 // not able to fail, only to not find
 // update callers if that changes
-optional<NodeVal> Processor::getAttribute(const AttrMap &attrs, NamePool::Id attrName) {
-    auto loc = attrs.attrMap.find(attrName);
-    if (loc == attrs.attrMap.end()) return nullopt;
-
-    return *loc->second;
-}
-
-optional<NodeVal> Processor::getAttribute(const NodeVal &node, NamePool::Id attrName) {
-    NamePool::Id typeId = getMeaningfulNameId(Meaningful::TYPE);
+const NodeVal* Processor::getAttribute(const NodeVal &node, NamePool::Id attrName) {
+    if (isMeaningful(attrName, Meaningful::TYPE)) {
+        if (!node.hasTypeAttr()) return nullptr;
 
-    if (attrName == typeId) {
-        if (!node.hasTypeAttr()) return nullopt;
-
-        return node.getTypeAttr();
+        return &node.getTypeAttr();
     } else {
-        if (!node.hasNonTypeAttrs()) return nullopt;
+        if (!node.hasNonTypeAttrs()) return nullptr;
 
-        return getAttribute(node.getNonTypeAttrs().getAttrMap(), attrName);
+        return node.getNonTypeAttrs().getAttrMap().find(attrName);
     }
 }
 
-optional<NodeVal> Processor::getAttribute(const NodeVal &node, const string &attrStrName) {
-    return getAttribute(node, namePool->add(attrStrName));
-}
+const NodeVal* Processor::getAttribute(const NodeVal &node, Attr attr) {
+    if (!node.hasNonTypeAttrs()) return nullptr;
 
-optional<bool> Processor::getAttributeForBool(const NodeVal &node, NamePool::Id attrName, bool default_) {
-    optional<NodeVal> attr = getAttribute(node, attrName);
-    if (!attr.has_value()) return default_;
-    if (!checkIsEvalVal(attr.value(), true)) return nullopt;
-    if (!checkIsBool(attr.value(), true)) return nullopt;
-    return attr.value().getEvalVal().b();
+    return node.getNonTypeAttrs().getAttrMap().find(getAttrNameId(attr));
 }
 
-optional<bool> Processor::getAttributeForBool(const NodeVal &node, const std::string &attrStrName, bool default_) {
-    return getAttributeForBool(node, namePool->add(attrStrName), default_);
+optional<bool> Processor::getAttributeForBool(const NodeVal &node, Attr attr, bool default_) {
+    const NodeVal *nodeAttr = getAttribute(node, attr);
+    if (nodeAttr == nullptr) return default_;
+    if (!checkIsEvalVal(*nodeAttr, true)) return nullopt;
+    if (!checkIsBool(*nodeAttr, true)) return nullopt;
+    return nodeAttr->getEvalVal().b();
 }
 
-optional<NodeVal> Processor::getAttributeFull(const NodeVal &node, NamePool::Id attrName) {
-    optional<NodeVal> attr = getAttribute(node, attrName);
-    if (attr.has_value()) return attr;
+const NodeVal* Processor::getAttributeFull(const NodeVal &node, NamePool::Id attrName) {
+    const NodeVal *attr = getAttribute(node, attrName);
+    if (attr != nullptr) return attr;
 
     if (checkIsType(node, false)) {
         TypeTable::Id baseTy = typeTable->extractExplicitTypeBaseType(node.getEvalVal().ty());
 
         const AttrMap *attrMap = symbolTable->getDataAttrs(baseTy);
-        if (attrMap != nullptr) {
-            optional<NodeVal> attr = getAttribute(*attrMap, attrName);
-            if (attr.has_value()) return attr;
+        if (attrMap != nullptr) return attrMap->find(attrName);
+    }
+
+    return nullptr;
+}
+
+optional<SymbolTable::LoopHints> Processor::getLoopHints(const NodeVal &node) {
+    SymbolTable::LoopHints hints;
+
+    // an empty raw means the hint was not given, so macros can forward hints
+    auto getHint = [&](Attr a) -> const NodeVal* {
+        const NodeVal *attr = getAttribute(node, a);
+        if (attr != nullptr && NodeVal::isEmpty(*attr, typeTable)) return nullptr;
+        return attr;
+    };
+
+    // these can be either bools or counts
+    auto getFlagOrCount = [&](Attr a, optional<bool> &flag, optional<uint64_t> &count) {
+        const NodeVal *attr = getHint(a);
+        if (attr == nullptr) return true;
+        if (!checkIsEvalVal(*attr, true)) return false;
+
+        if (EvalVal::isB(attr->getEvalVal(), typeTable)) {
+            flag = attr->getEvalVal().b();
+            return true;
+        }
+
+        optional<uint64_t> val;
+        if (EvalVal::isI(attr->getEvalVal(), typeTable) || EvalVal::isU(attr->getEvalVal(), typeTable)) {
+            val = EvalVal::getValueNonNeg(attr->getEvalVal(), typeTable);
+        }
+        if (!val.has_value() || val.value() == 0) {
+            msgs->errorLoopHintBadValue(attr->getCodeLoc(), getAttrNameId(a));
+            return false;
+        }
+
+        flag = true;
+        count = val.value();
+        return true;
+    };
+
+    if (!getFlagOrCount(Attr::VECTORIZE, hints.vectorize, hints.vectorizeWidth)) return nullopt;
+    if (!getFlagOrCount(Attr::UNROLL, hints.unroll, hints.unrollCount)) return nullopt;
+    if (!getFlagOrCount(Attr::INTERLEAVE, hints.interleave, hints.interleaveCount)) return nullopt;
+
+    const NodeVal *attrNoUnroll = getHint(Attr::NO_UNROLL);
+    if (attrNoUnroll != nullptr) {
+        if (!checkIsEvalVal(*attrNoUnroll, true) || !checkIsBool(*attrNoUnroll, true)) return nullopt;
+        if (attrNoUnroll->getEvalVal().b()) {
+            if (hints.unroll.has_value()) {
+                msgs->errorLoopHintsConflict(node.getNonTypeAttrs().getCodeLoc(), "unroll", "noUnroll");
+                return nullopt;
+            }
+            hints.unroll = false;
         }
     }
 
-    return nullopt;
+    const NodeVal *attrParallelAccesses = getHint(Attr::PARALLEL_ACCESSES);
+    if (attrParallelAccesses != nullptr) {
+        if (!checkIsEvalVal(*attrParallelAccesses, true) || !checkIsBool(*attrParallelAccesses, true)) return nullopt;
+        hints.parallelAccesses = attrParallelAccesses->getEvalVal().b();
+    }
+
+    return hints;
+}
+
+optional<optional<bool>> Processor::getLikelihood(const NodeVal &node) {
+    // an empty raw means the hint was not given, so macros can forward hints
+    auto getFlag = [&](Attr a) -> optional<bool> {
+        const NodeVal *attr = getAttribute(node, a);
+        if (attr == nullptr || NodeVal::isEmpty(*attr, typeTable)) return false;
+        if (!checkIsEvalVal(*attr, true) || !checkIsBool(*attr, true)) return nullopt;
+        return attr->getEvalVal().b();
+    };
+
+    optional<bool> attrLikely = getFlag(Attr::LIKELY);
+    if (!attrLikely.has_value()) return nullopt;
+    optional<bool> attrUnlikely = getFlag(Attr::UNLIKELY);
+    if (!attrUnlikely.has_value()) return nullopt;
+
+    if (attrLikely.value() && attrUnlikely.value()) {
+        msgs->errorCondLikelihoodConflict(node.getNonTypeAttrs().getCodeLoc());
+        return nullopt;
+    }
+
+    if (attrLikely.value()) return optional<bool>(true);
+    if (attrUnlikely.value()) return optional<bool>(false);
+    return optional<bool>();
+}
+
+optional<optional<uint64_t>> Processor::getAlignment(const NodeVal &node) {
+    const NodeVal *attr = getAttribute(node, Attr::ALIGN);
+    // an empty raw means the alignment was not given, so macros can forward it
+    if (attr == nullptr || NodeVal::isEmpty(*attr, typeTable)) return optional<uint64_t>();
+    if (!checkIsEvalVal(*attr, true)) return nullopt;
+
+    optional<uint64_t> val;
+    if (EvalVal::isI(attr->getEvalVal(), typeTable) || EvalVal::isU(attr->getEvalVal(), typeTable)) {
+        val = EvalVal::getValueNonNeg(attr->getEvalVal(), typeTable);
+    }
+    if (!val.has_value() || val.value() == 0 || (val.value() & (val.value()-1)) != 0) {
+        msgs->errorAlignBadValue(attr->getCodeLoc());
+        return nullopt;
+    }
+
+    return val;
 }
 
 NodeVal Processor::promoteBool(CodeLoc codeLoc, bool b) const {
@@ -1706,7 +2104,7 @@ NodeVal Processor::promoteLiteralVal(const NodeVal &node) {
         msgs->errorInternal(node.getCodeLoc());
         return NodeVal();
     }
-    NodeVal prom(node.getCodeLoc(), eval);
+    NodeVal prom(node.getCodeLoc(), move(eval));
 
     NodeVal::copyNonValFieldsLeaf(prom, node, typeTable);
 
@@ -1732,6 +2130,15 @@ bool Processor::canBeTypeDescrDecor(const NodeVal &node) {
         return isTypeDescrDecor(node.getEvalVal().id());
     }
 
+    // (vec <len>)
+    if (NodeVal::isRawVal(node, typeTable)) {
+        if (node.getChildrenCnt() != 2) return false;
+
+        const NodeVal &first = node.getChild(0);
+        return first.isEvalVal() && EvalVal::isId(first.getEvalVal(), typeTable) &&
+            isMeaningful(first.getEvalVal().id(), Meaningful::VEC);
+    }
+
     return EvalVal::isI(node.getEvalVal(), typeTable) || EvalVal::isU(node.getEvalVal(), typeTable);
 }
 
@@ -1741,7 +2148,45 @@ bool Processor::applyTypeDescrDecor(TypeTable::TypeDescr &descr, const NodeVal &
         return false;
     }
 
-    if (EvalVal::isId(node.getEvalVal(), typeTable)) {
+    if (NodeVal::isRawVal(node, typeTable)) {
+        if (!canBeTypeDescrDecor(node)) {
+            msgs->errorInvalidTypeDecorator(node.getCodeLoc());
+            return false;
+        }
+
+        bool isElemOk = descr.decors.empty() && !typeTable->worksAsExplicitType(descr.base) &&
+            (typeTable->worksAsTypeI(descr.base) || typeTable->worksAsTypeU(descr.base) ||
+            typeTable->worksAsTypeF(descr.base) || typeTable->worksAsTypeC(descr.base) ||
+            typeTable->worksAsTypeB(descr.base));
+        if (!isElemOk) {
+            msgs->errorBadVecElemType(node.getCodeLoc());
+            return false;
+        }
+
+        NodeVal len = processNode(node.getChild(1));
+        if (len.isInvalid()) return false;
+        if (!len.isEvalVal()) {
+            msgs->errorInvalidTypeDecorator(len.getCodeLoc());
+            return false;
+        }
+
+        optional<uint64_t> vecSize = EvalVal::getValueNonNeg(len.getEvalVal(), typeTable);
+        if (!vecSize.has_value() || vecSize.value() == 0) {
+            if (!vecSize.has_value()) {
+                optional<int64_t> integ = EvalVal::getValueI(len.getEvalVal(), typeTable);
+                if (integ.has_value()) {
+                    msgs->errorBadVecSize(len.getCodeLoc(), integ.value());
+                } else {
+                    msgs->errorInvalidTypeDecorator(len.getCodeLoc());
+                }
+            } else {
+                msgs->errorBadVecSize(len.getCodeLoc(), vecSize.value());
+            }
+            return false;
+        }
+
+        descr.addDecor({.type=TypeTable::TypeDescr::Decor::D_VEC, .len=vecSize.value()});
+    } else if (EvalVal::isId(node.getEvalVal(), typeTable)) {
         optional<Meaningful> mean = getMeaningful(node.getEvalVal().id());
         if (!mean.has_value() || !isTypeDescrDecor(mean.value())) {
             msgs->errorInvalidTypeDecorator(node.getCodeLoc());
@@ -1796,6 +2241,23 @@ NodeVal Processor::dispatchLoad(CodeLoc codeLoc, VarId varId, optional<NamePool:
     }
 }
 
+optional<NamePool::Id> Processor::getPlainId(const NodeVal &node) const {
+    if (node.hasTypeAttr() || node.hasNonTypeAttrs() || node.isEscaped()) return nullopt;
+    if (node.isLiteralVal() && node.getLiteralVal().kind == LiteralVal::Kind::kId) return node.getLiteralVal().val_id;
+    if (node.isEvalVal() && EvalVal::isId(node.getEvalVal(), typeTable)) return node.getEvalVal().id();
+    return nullopt;
+}
+
+optional<VarId> Processor::getPlainRawVarId(const NodeVal &node) const {
+    optional<NamePool::Id> id = getPlainId(node);
+    if (!id.has_value()) return nullopt;
+
+    optional<VarId> varId = symbolTable->getVarId(id.value());
+    if (!varId.has_value() || !NodeVal::isRawVal(symbolTable->getVar(varId.value()).var, typeTable)) return nullopt;
+
+    return varId;
+}
+
 NodeVal Processor::implicitCast(const NodeVal &node, TypeTable::Id ty, bool skipCheckNeedsDrop) {
     if (!checkImplicitCastable(node, ty, true)) return NodeVal();
 
@@ -1862,9 +2324,7 @@ bool Processor::shouldNotDispatchCastToEval(const NodeVal &node, TypeTable::Id d
     } else if (typeTable->worksAsTypeAnyP(srcTypeId)) {
         if (!EvalVal::isNull(val, typeTable)) {
             return typeTable->worksAsTypeI(dstTypeId) ||
-                typeTable->worksAsTypeU(dstTypeId) ||
-                typeTable->worksAsTypeB(dstTypeId) ||
-                typeTable->worksAsTypeAnyP(dstTypeId);
+                typeTable->worksAsTypeU(dstTypeId);
         }
     } else if (typeTable->worksAsCallable(srcTypeId)) {
         if (!EvalVal::isCallableNoValue(val, typeTable)) {
@@ -1979,6 +2439,16 @@ NodeVal Processor::getRawElement(CodeLoc codeLoc, NodeVal &raw, size_t index) {
     return evaluator->performOperIndex(codeLoc, raw, index, resType);
 }
 
+NodeVal Processor::getRawElement(CodeLoc codeLoc, VarId varId, size_t index) {
+    const NodeVal &raw = symbolTable->getVar(varId).var;
+    TypeTable::Id rawType = raw.getType().value();
+
+    TypeTable::Id resType = raw.getChild(index).getType().value();
+    if (typeTable->worksAsTypeCn(rawType)) resType = typeTable->addTypeCnOf(resType);
+
+    return evaluator->performOperIndex(codeLoc, varId, index, resType);
+}
+
 NodeVal Processor::getTupleElement(CodeLoc codeLoc, NodeVal &tuple, size_t index) {
     TypeTable::Id tupleType = tuple.getType().value();
 
@@ -2314,8 +2784,8 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
         if (node.getNonTypeAttrs().isAttrMap()) {
             AttrMap &attrMap = node.getNonTypeAttrs().getAttrMap();
 
-            for (auto &it : attrMap.attrMap) {
-                NodeVal &attrVal = *it.second;
+            for (size_t i = 0; i < attrMap.size(); ++i) {
+                NodeVal &attrVal = attrMap.vals[i];
 
                 if (forceUnescape) NodeVal::unescape(attrVal, typeTable, true);
 
@@ -2323,7 +2793,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                 if (attrVal.isInvalid()) return false;
                 if (!checkIsEvalVal(attrVal, true)) return false;
                 if (!hasTrivialDrop(attrVal.getType().value())) {
-                    msgs->errorAttributeOwning(attrVal.getCodeLoc(), it.first);
+                    msgs->errorAttributeOwning(attrVal.getCodeLoc(), attrMap.names[i]);
                     return false;
                 }
             }
@@ -2344,7 +2814,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
 
                 NodeVal attrVal = promoteBool(nodeAttrs.getCodeLoc(), true);
 
-                attrMap.attrMap.insert({attrName, make_unique<NodeVal>(move(attrVal))});
+                attrMap.insert(attrName, move(attrVal));
             } else {
                 for (size_t i = 0; i < nodeAttrs.getChildrenCnt(); ++i) {
                     NodeVal &nodeAttrEntry = nodeAttrs.getChild(i);
@@ -2366,7 +2836,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                         msgs->errorNonTypeAttributeType(nodeAttrEntryName->getCodeLoc());
                         return false;
                     }
-                    if (attrMap.attrMap.find(attrName) != attrMap.attrMap.end()) {
+                    if (attrMap.find(attrName) != nullptr) {
                         msgs->errorAttributesSameName(nodeAttrEntryName->getCodeLoc(), attrName);
                         return false;
                     }
@@ -2388,7 +2858,7 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
                         attrVal = NodeVal::moveNoRef(move(attrVal), LifetimeInfo());
                     }
 
-                    attrMap.attrMap.insert({attrName, make_unique<NodeVal>(move(attrVal))});
+                    attrMap.insert(attrName, move(attrVal));
                 }
             }
 
@@ -2401,6 +2871,14 @@ bool Processor::processAttributes(NodeVal &node, bool forceUnescape) {
 
 bool Processor::processChildNodes(const NodeVal &node) {
     for (size_t i = 0; i < node.getChildrenCnt(); ++i) {
+        // the value of a statement is unused, so appending to a raw var can skip copying it
+        // the var is read after the appended operands are processed, unlike when it is loaded for (+ x ...)
+        optional<bool> appended = processRawSelfAppend(node.getChild(i));
+        if (appended.has_value()) {
+            if (!appended.value()) return false;
+            continue;
+        }
+
         NodeVal tmp = processNode(node.getChild(i));
         if (tmp.isInvalid()) return false;
 
@@ -2416,6 +2894,26 @@ bool Processor::processChildNodes(const NodeVal &node) {
     return true;
 }
 
+NodeVal Processor::processBlockNonBare(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &nodeBody) {
+    if (!performBlockSetUp(codeLoc, block)) return NodeVal();
+
+    do {
+        BlockRaii blockRaii(symbolTable, block);
+
+        optional<bool> blockSuccess = performBlockBody(codeLoc, symbolTable->getLastBlock(), nodeBody);
+        if (!blockSuccess.has_value()) {
+            performBlockTearDown(codeLoc, symbolTable->getLastBlock(), false);
+            return NodeVal();
+        }
+
+        if (blockSuccess.value()) continue;
+
+        NodeVal ret = performBlockTearDown(codeLoc, symbolTable->getLastBlock(), true);
+        if (ret.isInvalid()) return NodeVal();
+        return ret;
+    } while (true);
+}
+
 NodeVal Processor::processFncType(const NodeVal &node) {
     // fnc argTypes ret
     size_t indArgs = 1;
@@ -2429,7 +2927,7 @@ NodeVal Processor::processFncType(const NodeVal &node) {
     if (!checkIsRaw(nodeArgs, true)) return NodeVal();
     argTypes.reserve(nodeArgs.getChildrenCnt());
     argNoDrops.reserve(nodeArgs.getChildrenCnt());
-    optional<bool> variadic = getAttributeForBool(nodeArgs, "variadic");
+    optional<bool> variadic = getAttributeForBool(nodeArgs, Attr::VARIADIC);
     if (!variadic.has_value()) return NodeVal();
     for (size_t i = 0; i < nodeArgs.getChildrenCnt(); ++i) {
         const NodeVal &nodeArg = nodeArgs.getChild(i);
@@ -2437,7 +2935,7 @@ NodeVal Processor::processFncType(const NodeVal &node) {
         NodeVal argTy = processAndCheckIsType(nodeArg);
         if (argTy.isInvalid()) return NodeVal();
 
-        optional<bool> attrNoDrop = getAttributeForBool(argTy, "noDrop");
+        optional<bool> attrNoDrop = getAttributeForBool(argTy, Attr::NO_DROP);
         if (!attrNoDrop.has_value()) return NodeVal();
 
         argTypes.push_back(argTy.getEvalVal().ty());
@@ -2496,7 +2994,7 @@ NodeVal Processor::processMacType(const NodeVal &node) {
         msgs->errorMacroTypeBadArgNumber(nodeArgNum.getCodeLoc());
         return NodeVal();
     }
-    optional<bool> variadic = getAttributeForBool(nodeArgNum, "variadic");
+    optional<bool> variadic = getAttributeForBool(nodeArgNum, Attr::VARIADIC);
     if (!variadic.has_value()) return NodeVal();
 
     // macro type
@@ -2530,16 +3028,33 @@ NodeVal Processor::processOperUnary(CodeLoc codeLoc, const NodeVal &starting, co
     if (op == Oper::MUL) {
         return dispatchOperUnaryDeref(codeLoc, operProc);
     } else if (op == Oper::SHR) {
-        optional<bool> attrNoZero = getAttributeForBool(starting, "noZero");
+        optional<bool> attrNoZero = getAttributeForBool(starting, Attr::NO_ZERO);
         if (!attrNoZero.has_value()) return NodeVal();
 
         return moveNode(codeLoc, move(operProc), attrNoZero.value());
     } else {
+        // negation flips the likelihood of a condition, so (exit (! cond)) keeps the hints of cond
+        optional<optional<bool>> likely;
+        if (op == Oper::NOT) {
+            likely = getLikelihood(operProc);
+            if (!likely.has_value()) return NodeVal();
+        }
+
+        NodeVal ret;
         if (checkIsEvalTime(operProc, false)) {
-            return evaluator->performOperUnary(codeLoc, move(operProc), op);
+            ret = evaluator->performOperUnary(codeLoc, move(operProc), op);
         } else {
-            return performOperUnary(codeLoc, move(operProc), op);
+            ret = performOperUnary(codeLoc, move(operProc), op);
         }
+        if (ret.isInvalid()) return NodeVal();
+
+        if (likely.has_value() && likely.value().has_value()) {
+            AttrMap attrMap;
+            attrMap.insert(getAttrNameId(likely.value().value() ? Attr::UNLIKELY : Attr::LIKELY), promoteBool(codeLoc, true));
+            ret.setNonTypeAttrs(NodeVal(codeLoc, move(attrMap)));
+        }
+
+        return ret;
     }
 }
 
@@ -2552,6 +3067,27 @@ NodeVal Processor::processOperComparison(CodeLoc codeLoc, const std::vector<cons
     NodeVal lhs = processAndCheckHasType(*opers[0]);
     if (lhs.isInvalid()) return NodeVal();
 
+    if (typeTable->worksAsTypeVec(lhs.getType().value())) {
+        if (opers.size() > 2) {
+            msgs->errorExprCmpVecArgNum(codeLoc);
+            return NodeVal();
+        }
+
+        NodeVal rhs = processAndCheckHasType(*opers[1]);
+        if (rhs.isInvalid()) return NodeVal();
+
+        if (!implicitCastOperands(lhs, rhs, false)) return NodeVal();
+
+        size_t len = typeTable->extractLenOfVec(lhs.getType().value()).value();
+        TypeTable::Id resTy = typeTable->addTypeVecOfLenIdOf(typeTable->getPrimTypeId(TypeTable::P_BOOL), len);
+
+        if (checkIsEvalTime(lhs, false) && checkIsEvalTime(rhs, false)) {
+            return evaluator->performOperComparisonVec(codeLoc, lhs, rhs, op, resTy);
+        } else {
+            return performOperComparisonVec(codeLoc, lhs, rhs, op, resTy);
+        }
+    }
+
     // redirecting to evaluator when all operands are EvalVals is more complicated in the case of comparisons
     // the reason is that LLVM's phi nodes need to be started up and closed appropriately
     ComparisonSignal signal;
@@ -2625,7 +3161,7 @@ NodeVal Processor::processOperAssignment(CodeLoc codeLoc, const std::vector<cons
             return NodeVal();
         }
 
-        optional<bool> attrNoDrop = getAttributeForBool(lhs, "noDrop");
+        optional<bool> attrNoDrop = getAttributeForBool(lhs, Attr::NO_DROP);
         if (!attrNoDrop.has_value()) return NodeVal();
 
         if (!implicitCastOperands(lhs, rhs, true)) return NodeVal();
@@ -2646,11 +3182,102 @@ NodeVal Processor::processOperAssignment(CodeLoc codeLoc, const std::vector<cons
     return rhs;
 }
 
+optional<bool> Processor::processRawSelfAppend(const NodeVal &node) {
+    auto isPlainNonLeaf = [&](const NodeVal &n) {
+        return !n.hasTypeAttr() && !n.hasNonTypeAttrs() && !n.isEscaped() && !NodeVal::isLeaf(n, typeTable);
+    };
+    auto isPlainOper = [&](const NodeVal &n, Oper op) {
+        optional<NamePool::Id> id = getPlainId(n);
+        return id.has_value() && isOper(id.value(), op);
+    };
+
+    if (!isPlainNonLeaf(node) || node.getChildrenCnt() != 3 || !isPlainOper(node.getChild(0), Oper::ASGN)) return nullopt;
+
+    const NodeVal &nodeConcat = node.getChild(2);
+    if (!isPlainNonLeaf(nodeConcat) || nodeConcat.getChildrenCnt() < 3 || !isPlainOper(nodeConcat.getChild(0), Oper::ADD)) return nullopt;
+
+    optional<NamePool::Id> id = getPlainId(node.getChild(1));
+    if (!id.has_value() || getPlainId(nodeConcat.getChild(1)) != id) return nullopt;
+
+    optional<VarId> varId = getPlainRawVarId(node.getChild(1));
+    if (!varId.has_value()) return nullopt;
+
+    // x is appended to after the operands are processed, while the general path reads it before that
+    for (size_t i = 2; i < nodeConcat.getChildrenCnt(); ++i) {
+        if (!cannotWriteVars(nodeConcat.getChild(i))) return nullopt;
+    }
+
+    // these get reported by processOperAssignment
+    const NodeVal &var = symbolTable->getVar(varId.value()).var;
+    if (var.isInvokeArg() || typeTable->worksAsTypeCn(var.getType().value())) return nullopt;
+
+    // stands in for x, as only its type and lifetime are looked at until the assignment itself
+    NodeVal lhs(node.getChild(1).getCodeLoc(), EvalVal::makeVal(var.getType().value(), typeTable));
+    lhs.setLifetimeInfo(var.getLifetimeInfo().value());
+
+    // the elements to append, concatenated and cast the same way processOperRegular would do after x
+    NodeVal appended(nodeConcat.getChild(1).getCodeLoc(), EvalVal::makeVal(var.getType().value(), typeTable));
+    for (size_t i = 2; i < nodeConcat.getChildrenCnt(); ++i) {
+        NodeVal operand = processAndCheckHasType(nodeConcat.getChild(i));
+        if (operand.isInvalid()) return false;
+
+        if (!implicitCastOperands(appended, operand, false)) return false;
+
+        CodeLoc codeLocAdd = nodeConcat.getChild(0).getCodeLoc();
+        NodeVal nextAppended;
+        if (checkIsEvalTime(operand, false)) {
+            nextAppended = evaluator->performOperRegular(codeLocAdd, appended, operand, Oper::ADD, OperRegAttrs());
+        } else {
+            nextAppended = performOperRegular(codeLocAdd, appended, operand, Oper::ADD, OperRegAttrs());
+        }
+        if (nextAppended.isInvalid()) return false;
+
+        appended = move(nextAppended);
+    }
+
+    // the same checks as in processOperAssignment, which pass for appended iff they pass for the whole concatenation
+    // raws have trivial drops, so the old value of x needs no dropping
+    CodeLoc codeLocAsgn = node.getChild(0).getCodeLoc();
+    if (!implicitCastOperands(lhs, appended, true)) return false;
+    if (!checkTransferValueOk(codeLocAsgn, appended, lhs.isNoDrop(), lhs.isInvokeArg(), true)) return false;
+
+    return evaluator->performRawAppend(codeLocAsgn, varId.value(), move(appended));
+}
+
+bool Processor::cannotWriteVars(const NodeVal &node) const {
+    if (node.hasTypeAttr() || node.hasNonTypeAttrs()) return false;
+    if (NodeVal::isLeaf(node, typeTable)) return true;
+
+    // escaped nodes only process their unescaped parts, of which hole-free ones have none
+    if (node.isEscaped()) {
+        if (node.isHoleFree()) return true;
+    } else {
+        optional<NamePool::Id> id = getPlainId(node.getChild(0));
+        if (!id.has_value()) return false;
+
+        // anything else may be a call, an invocation, or a special form with effects
+        optional<Oper> op = getOper(id.value());
+        optional<Keyword> keyw = getKeyword(id.value());
+        bool readOnly = (op.has_value() && op != Oper::ASGN && op != Oper::SHR) ||
+            keyw == Keyword::TYPE_OF || keyw == Keyword::LEN_OF || keyw == Keyword::SIZE_OF;
+        if (!readOnly) return false;
+    }
+
+    return all_of(node.getEvalVal().elems().begin(), node.getEvalVal().elems().end(), [&](const NodeVal &child) {
+        return cannotWriteVars(child);
+    });
+}
+
 NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers) {
-    NodeVal lhs = processNode(*opers[0]);
+    // raw vars are indexed where they are stored, as loading them would copy all of their elements
+    optional<VarId> rawVarId = getPlainRawVarId(*opers[0]);
+
+    NodeVal lhs;
+    if (rawVarId.has_value()) lhs = processOperIndexRawVar(rawVarId.value(), *opers[1]);
+    else lhs = processNode(*opers[0]);
     if (lhs.isInvalid()) return NodeVal();
 
-    for (size_t i = 1; i < opers.size(); ++i) {
+    for (size_t i = rawVarId.has_value() ? 2 : 1; i < opers.size(); ++i) {
         if (!checkHasType(lhs, true)) return NodeVal();
 
         TypeTable::Id baseType = lhs.getType().value();
@@ -2660,7 +3287,8 @@ NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const Nod
         bool isBaseData = typeTable->worksAsDataType(baseType);
         bool isBaseArr = typeTable->worksAsTypeArr(baseType);
         bool isBaseArrP = typeTable->worksAsTypeArrP(baseType);
-        if (!isBaseRaw && !isBaseTup && !isBaseData && !isBaseArr && !isBaseArrP) {
+        bool isBaseVec = typeTable->worksAsTypeVec(baseType);
+        if (!isBaseRaw && !isBaseTup && !isBaseData && !isBaseArr && !isBaseArrP && !isBaseVec) {
             msgs->errorExprIndexOnBadType(lhs.getCodeLoc(), lhs.getType().value());
             return NodeVal();
         }
@@ -2684,6 +3312,8 @@ NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const Nod
             baseLen = typeTable->extractLenOfDataType(baseType).value();
         } else if (isBaseArr) {
             baseLen = typeTable->extractLenOfArr(baseType).value();
+        } else if (isBaseVec) {
+            baseLen = typeTable->extractLenOfVec(baseType).value();
         }
 
         NodeVal index;
@@ -2711,17 +3341,8 @@ NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const Nod
             }
 
             if (!isBaseArrP && index.isEvalVal()) {
-                indexVal = EvalVal::getValueNonNeg(index.getEvalVal(), typeTable);
-                if ((!indexVal.has_value()) || (baseLen.has_value() && indexVal.value() >= baseLen)) {
-                    if (EvalVal::isI(index.getEvalVal(), typeTable)) {
-                        int64_t ind = EvalVal::getValueI(index.getEvalVal(), typeTable).value();
-                        msgs->errorExprIndexOutOfBounds(index.getCodeLoc(), ind, baseLen);
-                    } else {
-                        uint64_t ind = EvalVal::getValueU(index.getEvalVal(), typeTable).value();
-                        msgs->errorExprIndexOutOfBounds(index.getCodeLoc(), ind, baseLen);
-                    }
-                    return NodeVal();
-                }
+                indexVal = getIndexInBounds(index, baseLen);
+                if (!indexVal.has_value()) return NodeVal();
             }
         }
 
@@ -2736,7 +3357,7 @@ NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const Nod
             lhs = getTupleElement(lhs.getCodeLoc(), lhs, (size_t) indexVal.value());
         } else if (isBaseData) {
             lhs = getDataElement(lhs.getCodeLoc(), lhs, (size_t) indexVal.value());
-        } else if (isBaseArr || isBaseArrP) {
+        } else if (isBaseArr || isBaseArrP || isBaseVec) {
             lhs = getArrElement(lhs.getCodeLoc(), lhs, index);
             if (lhs.isInvalid()) return NodeVal();
         } else {
@@ -2749,11 +3370,48 @@ NodeVal Processor::processOperIndex(CodeLoc codeLoc, const std::vector<const Nod
     return lhs;
 }
 
+NodeVal Processor::processOperIndexRawVar(VarId varId, const NodeVal &nodeIndex) {
+    NodeVal index = processAndCheckHasType(nodeIndex);
+    if (index.isInvalid()) return NodeVal();
+
+    if (!typeTable->worksAsTypeI(index.getType().value()) && !typeTable->worksAsTypeU(index.getType().value())) {
+        msgs->errorExprIndexNotIntegral(index.getCodeLoc());
+        return NodeVal();
+    }
+    if (!index.isEvalVal()) {
+        msgs->errorNotEvalVal(index.getCodeLoc());
+        return NodeVal();
+    }
+
+    // fetched only now, as processing the index may have registered new vars
+    size_t len = symbolTable->getVar(varId).var.getChildrenCnt();
+    optional<uint64_t> indexVal = getIndexInBounds(index, len);
+    if (!indexVal.has_value()) return NodeVal();
+
+    return getRawElement(nodeIndex.getCodeLoc(), varId, (size_t) indexVal.value());
+}
+
+optional<uint64_t> Processor::getIndexInBounds(const NodeVal &index, optional<size_t> len) {
+    optional<uint64_t> indexVal = EvalVal::getValueNonNeg(index.getEvalVal(), typeTable);
+    if ((!indexVal.has_value()) || (len.has_value() && indexVal.value() >= len)) {
+        if (EvalVal::isI(index.getEvalVal(), typeTable)) {
+            int64_t ind = EvalVal::getValueI(index.getEvalVal(), typeTable).value();
+            msgs->errorExprIndexOutOfBounds(index.getCodeLoc(), ind, len);
+        } else {
+            uint64_t ind = EvalVal::getValueU(index.getEvalVal(), typeTable).value();
+            msgs->errorExprIndexOutOfBounds(index.getCodeLoc(), ind, len);
+        }
+        return nullopt;
+    }
+
+    return indexVal;
+}
+
 NodeVal Processor::processOperRegular(CodeLoc codeLoc, const NodeVal &starting, const std::vector<const NodeVal*> &opers, Oper op) {
-    optional<bool> attrNoWrap = getAttributeForBool(starting, "noWrap");
+    optional<bool> attrNoWrap = getAttributeForBool(starting, Attr::NO_WRAP);
     if (!attrNoWrap.has_value()) return NodeVal();
 
-    optional<bool> attrBare = getAttributeForBool(starting, "bare");
+    optional<bool> attrBare = getAttributeForBool(starting, Attr::BARE);
     if (!attrBare.has_value()) return NodeVal();
 
     OperInfo operInfo = operInfos.find(op)->second;
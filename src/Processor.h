@@ -1,12 +1,14 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
 #include <vector>
 #include "BlockRaii.h"
 #include "ComparisonSignal.h"
 #include "CompilationMessages.h"
 #include "NamePool.h"
 #include "NodeVal.h"
+#include "reserved.h"
 #include "StringPool.h"
 #include "SymbolTable.h"
 #include "TypeTable.h"
@@ -23,26 +25,49 @@ protected:
     Evaluator *evaluator;
     Processor *compiler;
 
+    // promoted children of quoted hole-free nodes, by their id, with the escape score of the node they were promoted for
+    std::unordered_map<std::uint32_t, std::pair<EscapeScore, std::vector<NodeVal>>> holeFreeElems;
+
 protected:
     struct OperRegAttrs {
         bool noWrap = false;
         bool bare = false;
     };
 
+    enum class AtomicOrdering {
+        RELAXED,
+        ACQUIRE,
+        RELEASE,
+        ACQ_REL,
+        SEQ_CST
+    };
+
+    struct SymAttrs {
+        bool threadLocal = false;
+        std::optional<std::uint64_t> align;
+    };
+
+    struct AtomicAttrs {
+        AtomicOrdering ordering = AtomicOrdering::SEQ_CST;
+        bool weak = false;
+    };
+
     virtual NodeVal performLoad(CodeLoc codeLoc, VarId varId) =0;
     virtual NodeVal performLoad(CodeLoc codeLoc, FuncId funcId) =0;
     virtual NodeVal performLoad(CodeLoc codeLoc, MacroId macroId) =0;
     virtual NodeVal performZero(CodeLoc codeLoc, TypeTable::Id ty) =0;
-    virtual NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty) =0;
-    virtual NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init) =0;
+    virtual NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, CodeLoc codeLocTy, TypeTable::Id ty, SymAttrs attrs) =0;
+    virtual NodeVal performRegister(CodeLoc codeLoc, NamePool::Id id, NodeVal init, SymAttrs attrs) =0;
     virtual NodeVal performCast(CodeLoc codeLoc, const NodeVal &node, CodeLoc codeLocTy, TypeTable::Id ty) =0;
     virtual bool performBlockSetUp(CodeLoc codeLoc, SymbolTable::Block &block) =0;
     // Returns nullopt in case of fail. Otherwise, returns whether the body should be processed again.
     virtual std::optional<bool> performBlockBody(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &nodeBody) =0;
     virtual NodeVal performBlockTearDown(CodeLoc codeLoc, SymbolTable::Block block, bool success) =0;
-    virtual bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) =0;
-    virtual bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond) =0;
+    virtual bool performExit(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) =0;
+    virtual bool performLoop(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &cond, std::optional<bool> likely) =0;
     virtual bool performPass(CodeLoc codeLoc, SymbolTable::Block block, NodeVal val) =0;
+    // Has one body per entry in caseVals, followed by the default body if one was given.
+    virtual bool performBranch(CodeLoc codeLoc, const NodeVal &val, const std::vector<std::vector<NodeVal>> &caseVals, const std::vector<const NodeVal*> &bodies) =0;
     virtual bool performDataDefinition(CodeLoc codeLoc, TypeTable::Id ty) =0;
     virtual NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, const NodeVal &func, const std::vector<NodeVal> &args) =0;
     virtual NodeVal performCall(CodeLoc codeLoc, CodeLoc codeLocFunc, FuncId funcId, const std::vector<NodeVal> &args) =0;
@@ -58,13 +83,22 @@ protected:
     // Returns nullopt in case of fail. Otherwise, returns whether the variadic comparison may exit early.
     virtual std::optional<bool> performOperComparison(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, ComparisonSignal &signal) =0;
     virtual NodeVal performOperComparisonTearDown(CodeLoc codeLoc, bool success, ComparisonSignal signal) =0;
+    // Compares vectors lane by lane, resulting in a vector of bools.
+    virtual NodeVal performOperComparisonVec(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, TypeTable::Id resTy) =0;
     virtual NodeVal performOperAssignment(CodeLoc codeLoc, const NodeVal &lhs, NodeVal rhs) =0;
-    // Called for arrays and array pointers.
+    // Called for arrays, array pointers, and vectors.
     virtual NodeVal performOperIndexArr(CodeLoc codeLoc, NodeVal &base, const NodeVal &ind, TypeTable::Id resTy) =0;
     // Called for raws, tuples, and data types.
     virtual NodeVal performOperIndex(CodeLoc codeLoc, NodeVal &base, std::uint64_t ind, TypeTable::Id resTy) =0;
     virtual NodeVal performOperRegular(CodeLoc codeLoc, const NodeVal &lhs, const NodeVal &rhs, Oper op, OperRegAttrs attrs) =0;
     virtual std::optional<std::uint64_t> performSizeOf(CodeLoc codeLoc, TypeTable::Id ty) =0;
+    virtual NodeVal performAtomicLoad(CodeLoc codeLoc, const NodeVal &ptr, TypeTable::Id resTy, AtomicAttrs attrs) =0;
+    virtual bool performAtomicStore(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicAttrs attrs) =0;
+    // Returns the value pointed to before the operation.
+    virtual NodeVal performAtomicRmw(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &val, AtomicOp op, TypeTable::Id resTy, AtomicAttrs attrs) =0;
+    // Returns a tuple of the value pointed to before the operation and whether the exchange happened.
+    virtual NodeVal performAtomicCmpXchg(CodeLoc codeLoc, const NodeVal &ptr, const NodeVal &expected, const NodeVal &desired, TypeTable::Id resTy, AtomicAttrs attrs) =0;
+    virtual bool performFence(CodeLoc codeLoc, AtomicAttrs attrs) =0;
 
 protected:
     bool checkInGlobalScope(CodeLoc codeLoc, bool orError);
@@ -113,23 +147,34 @@ private:
     NodeVal processOperUnary(CodeLoc codeLoc, const NodeVal &starting, const NodeVal &oper, Oper op);
     NodeVal processOperComparison(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers, Oper op);
     NodeVal processOperAssignment(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
+    // nullopt if node is not a statement of form (= x (+ x ...)) on an evaluated raw x, otherwise whether successful
+    std::optional<bool> processRawSelfAppend(const NodeVal &node);
+    // conservatively false if processing node may assign to or move from any var
+    bool cannotWriteVars(const NodeVal &node) const;
     NodeVal processOperIndex(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
+    NodeVal processOperIndexRawVar(VarId varId, const NodeVal &nodeIndex);
+    // nullopt and an error if the evaluated index is negative or not below len
+    std::optional<std::uint64_t> getIndexInBounds(const NodeVal &index, std::optional<std::size_t> len);
     NodeVal processOperIndexNonArr(CodeLoc codeLoc, const std::vector<const NodeVal*> &opers);
     NodeVal processOperRegular(CodeLoc codeLoc, const NodeVal &starting, const std::vector<const NodeVal*> &opers, Oper op);
 
     bool processAttributes(NodeVal &node, bool forceUnescape = false);
 protected:
     bool processChildNodes(const NodeVal &node);
+    NodeVal processBlockNonBare(CodeLoc codeLoc, SymbolTable::Block block, const NodeVal &nodeBody);
 
-    std::optional<NodeVal> getAttribute(const AttrMap &attrs, NamePool::Id attrName);
-    std::optional<NodeVal> getAttribute(const NodeVal &node, NamePool::Id attrName);
-    std::optional<NodeVal> getAttribute(const NodeVal &node, const std::string &attrStrName);
-    // nullopt on error, otherwise attribute value, or default value if not present
-    std::optional<bool> getAttributeForBool(const NodeVal &node, NamePool::Id attrName, bool default_ = false);
+    // nullptr if not present, the attribute is not copied
+    const NodeVal* getAttribute(const NodeVal &node, NamePool::Id attrName);
+    const NodeVal* getAttribute(const NodeVal &node, Attr attr);
     // nullopt on error, otherwise attribute value, or default value if not present
-    std::optional<bool> getAttributeForBool(const NodeVal &node, const std::string &attrStrName, bool default_ = false);
+    std::optional<bool> getAttributeForBool(const NodeVal &node, Attr attr, bool default_ = false);
     // like getAttribute, but can lookup type-specific attributes if node is a type
-    std::optional<NodeVal> getAttributeFull(const NodeVal &node, NamePool::Id attrName);
+    const NodeVal* getAttributeFull(const NodeVal &node, NamePool::Id attrName);
+    std::optional<SymbolTable::LoopHints> getLoopHints(const NodeVal &node);
+    // nullopt on error, otherwise whether the condition is likely or unlikely to be true, if marked
+    std::optional<std::optional<bool>> getLikelihood(const NodeVal &node);
+    // nullopt on error, otherwise the requested alignment in bytes, if given
+    std::optional<std::optional<std::uint64_t>> getAlignment(const NodeVal &node);
 private:
     NodeVal promoteBool(CodeLoc codeLoc, bool b) const;
     NodeVal promoteType(CodeLoc codeLoc, TypeTable::Id ty) const;
@@ -138,6 +183,10 @@ private:
     bool applyTypeDescrDecor(TypeTable::TypeDescr &descr, const NodeVal &node);
     bool applyTupleElem(TypeTable::Tuple &tup, const NodeVal &node);
     NodeVal dispatchLoad(CodeLoc codeLoc, VarId varId, std::optional<NamePool::Id> id = std::nullopt);
+    // id of a leaf without attributes, which gets processed as a symbol
+    std::optional<NamePool::Id> getPlainId(const NodeVal &node) const;
+    // var of an evaluated raw, if the node is its plain id
+    std::optional<VarId> getPlainRawVarId(const NodeVal &node) const;
     NodeVal implicitCast(const NodeVal &node, TypeTable::Id ty, bool skipCheckNeedsDrop = false);
     NodeVal castNode(CodeLoc codeLoc, const NodeVal &node, CodeLoc codeLocTy, TypeTable::Id ty, bool skipCheckNeedsDrop = false);
     bool implicitCastOperands(NodeVal &lhs, NodeVal &rhs, bool oneWayOnly);
@@ -150,6 +199,7 @@ private:
     NodeVal getArrElement(CodeLoc codeLoc, NodeVal &array, std::size_t index);
     NodeVal getArrElement(CodeLoc codeLoc, NodeVal &array, const NodeVal &index);
     NodeVal getRawElement(CodeLoc codeLoc, NodeVal &raw, std::size_t index);
+    NodeVal getRawElement(CodeLoc codeLoc, VarId varId, std::size_t index);
     NodeVal getTupleElement(CodeLoc codeLoc, NodeVal &tuple, std::size_t index);
     NodeVal getDataElement(CodeLoc codeLoc, NodeVal &data, std::size_t index);
     bool argsFitFuncCall(const std::vector<NodeVal> &args, const TypeTable::Callable &callable, bool allowImplicitCasts);
@@ -177,6 +227,8 @@ private:
     NodeVal processExit(const NodeVal &node);
     NodeVal processLoop(const NodeVal &node);
     NodeVal processPass(const NodeVal &node);
+    NodeVal processBranch(const NodeVal &node);
+    NodeVal processAtomic(const NodeVal &node, const NodeVal &starting);
     NodeVal processExplicit(const NodeVal &node, const NodeVal &starting);
     NodeVal processData(const NodeVal &node, const NodeVal &starting);
     NodeVal processCall(const NodeVal &node, const NodeVal &starting);
@@ -199,6 +251,8 @@ private:
     NodeVal processLeaf(const NodeVal &node);
     NodeVal processNonLeaf(const NodeVal &node, bool topmost = false);
     NodeVal processNonLeafEscaped(const NodeVal &node);
+    NodeVal processNonLeafEscapedHoleFree(const NodeVal &node);
+    NodeVal promoteHoleFree(const NodeVal &node);
 
 public:
     Processor(NamePool *namePool, StringPool *stringPool, TypeTable *typeTable, SymbolTable *symbolTable, CompilationMessages *msgs);
@@ -1,4 +1,5 @@
 #include "ProgramArgs.h"
+#include <climits>
 #include <filesystem>
 #include <iostream>
 #include "OrbCompilerConfig.h"
@@ -8,6 +9,7 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
     ProgramArgs programArgs;
 
     bool emitLlvm = false;
+    bool emitDep = false;
 
     for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
@@ -16,6 +18,15 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
             programArgs.link = false;
         } else if (arg == "-emit-llvm") {
             emitLlvm = true;
+        } else if (arg == "-MD") {
+            emitDep = true;
+        } else if (arg == "-MF") {
+            if (i+1 == argc) {
+                out << "Argument to -MF must be specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.outputDep = argv[++i];
         } else if (arg == "-o") {
             if (i+1 == argc) {
                 out << "Argument to -o must be specified." << endl;
@@ -23,6 +34,45 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
             }
 
             programArgs.outputBin = argv[++i];
+        } else if (arg == "-cache-dir") {
+            if (i+1 == argc) {
+                out << "Argument to -cache-dir must be specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.cacheDir = argv[++i];
+        } else if (arg == "-eval-depth-limit") {
+            if (i+1 == argc) {
+                out << "Argument to -eval-depth-limit must be specified." << endl;
+                return nullopt;
+            }
+
+            char *end = nullptr;
+            errno = 0;
+            unsigned long num = strtoul(argv[++i], &end, 10);
+            if (errno == ERANGE || *end != '\0' || end == argv[i] || num == 0 || num > UINT_MAX) {
+                out << "Bad evaluation depth limit specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.evalDepthLimit = static_cast<unsigned>(num);
+        } else if (arg == "-eval-step-limit") {
+            if (i+1 == argc) {
+                out << "Argument to -eval-step-limit must be specified." << endl;
+                return nullopt;
+            }
+
+            char *end = nullptr;
+            errno = 0;
+            unsigned long long num = strtoull(argv[++i], &end, 10);
+            if (errno == ERANGE || *end != '\0' || end == argv[i] || num == 0) {
+                out << "Bad evaluation step limit specified." << endl;
+                return nullopt;
+            }
+
+            programArgs.evalStepLimit = num;
+        } else if (arg == "-eval-profile") {
+            programArgs.evalProfile = true;
         } else if (arg.rfind("-O", 0) == 0) {
             char *end = nullptr;
             unsigned long num;
@@ -74,6 +124,10 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
             out << "No source input files specified when emitting LLVM output requested." << endl;
             failure = true;
         }
+        if (emitDep) {
+            out << "No source input files specified when emitting dependencies requested." << endl;
+            failure = true;
+        }
 
         if (failure) return nullopt;
     }
@@ -96,6 +150,14 @@ optional<ProgramArgs> ProgramArgs::parseArgs(int argc,  char** argv, std::ostrea
         programArgs.outputLlvm = firstInputStem + ".ll";
     }
 
+    if (programArgs.outputDep.has_value() && !emitDep) {
+        out << "-MF specified without -MD." << endl;
+        return nullopt;
+    }
+    if (emitDep && !programArgs.outputDep.has_value()) {
+        programArgs.outputDep = filesystem::path(programArgs.outputBin).replace_extension(".d").string();
+    }
+
     return programArgs;
 }
 
@@ -106,10 +168,18 @@ Usage: orbc [options] file...
 Files can be .orb or object files.
 
 Options:
-  -c         Only process and compile, but do not link.
-  -emit-llvm Print the LLVM representation into a .ll file.
-  -I<dir>    Add directory <dir> to import search paths.
-  -o <file>  Place the binary output into <file>.
-  -O<num>    Set the optimization level. -O0, -O1, -O2, and -O3 are valid.
+  -c               Only process and compile, but do not link.
+  -cache-dir <dir> Reuse object code from <dir> if the whole processed program is unchanged.
+  -emit-llvm       Print the LLVM representation into a .ll file.
+  -eval-depth-limit <num>
+                   Fail if evaluated calls nest deeper than <num>. Defaults to 4096.
+  -eval-profile    Print the time spent evaluating each function and macro.
+  -eval-step-limit <num>
+                   Fail if evaluation processes more than <num> nodes.
+  -I<dir>          Add directory <dir> to import search paths.
+  -MD              Write the list of processed .orb files into a Make-style .d file.
+  -MF <file>       With -MD, write dependencies into <file>.
+  -o <file>        Place the binary output into <file>.
+  -O<num>          Set the optimization level. -O0, -O1, -O2, and -O3 are valid.
 )orbc_help";
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -7,9 +8,12 @@
 struct ProgramArgs {
     std::vector<std::string> inputsSrc, inputsOther, importPaths;
     std::string outputBin;
-    std::optional<std::string> outputLlvm;
+    std::optional<std::string> outputLlvm, outputDep, cacheDir;
     bool link = true;
     std::optional<unsigned> optLvl;
+    unsigned evalDepthLimit = 4096;
+    std::optional<std::uint64_t> evalStepLimit;
+    bool evalProfile = false;
 
     static std::optional<ProgramArgs> parseArgs(int argc, char** argv, std::ostream &out);
     static void printHelp(std::ostream &out);
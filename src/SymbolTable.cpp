@@ -103,6 +103,13 @@ SymbolTable::VarEntry& SymbolTable::getVar(VarId varId) {
     }
 }
 
+LifetimeInfo::NestLevel SymbolTable::getNestLevel(VarId varId) const {
+    LifetimeInfo::NestLevel nestLevel;
+    nestLevel.callable = varId.callable.has_value() ? varId.callable.value()+1 : 0;
+    nestLevel.local = varId.block+1;
+    return nestLevel;
+}
+
 bool SymbolTable::isVarName(NamePool::Id name) const {
     return getVarId(name).has_value();
 }
@@ -34,12 +34,25 @@ public:
 };
 
 struct FuncValue : public BaseCallableValue {
+    // only affect compilation
+    struct Hints {
+        bool inline_ = false, noInline = false, flatten = false;
+        bool hot = false, cold = false;
+        bool pure = false, noReturn = false;
+    };
+
     bool noNameMangle = false;
+    Hints hints;
+    std::vector<bool> argNoAliases;
     bool defined = false;
     bool isEvalFunc = false;
+    // only affects evaluation
+    bool memoize = false;
 
     llvm::Function *llvmFunc = nullptr;
     std::unique_ptr<NodeVal> evalFunc;
+    // results of evaluated calls of a memoized func, by structural hash of their args
+    std::unordered_multimap<std::size_t, std::pair<std::vector<NodeVal>, NodeVal>> evalMemo;
 
     bool isLlvm() const { return llvmFunc != nullptr; }
     bool isEval() const { return isEvalFunc; }
@@ -62,11 +75,24 @@ struct MacroValue : public BaseCallableValue {
 
 class SymbolTable {
 public:
+    // only affect compiled loops
+    struct LoopHints {
+        std::optional<bool> vectorize, unroll, interleave;
+        std::optional<std::uint64_t> vectorizeWidth, unrollCount, interleaveCount;
+        bool parallelAccesses = false;
+
+        bool isEmpty() const {
+            return !vectorize.has_value() && !unroll.has_value() && !interleave.has_value() && !parallelAccesses;
+        }
+    };
+
     struct Block {
         std::optional<NamePool::Id> name;
         std::optional<TypeTable::Id> type;
+        LoopHints loopHints;
         llvm::BasicBlock *blockExit = nullptr, *blockLoop = nullptr;
         llvm::PHINode *phi = nullptr;
+        llvm::MDNode *llvmLoopMd = nullptr, *llvmAccessGroup = nullptr;
 
         bool isEval() const { return blockExit == nullptr && blockLoop == nullptr && phi == nullptr; }
     };
@@ -155,6 +181,7 @@ public:
     VarId addVar(VarEntry var, bool forGlobal = false);
     const VarEntry& getVar(VarId varId) const;
     VarEntry& getVar(VarId varId);
+    LifetimeInfo::NestLevel getNestLevel(VarId varId) const;
     bool isVarName(NamePool::Id name) const;
     std::optional<VarId> getVarId(NamePool::Id name) const;
 
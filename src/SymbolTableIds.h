@@ -1,15 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include "NamePool.h"
+#include "utils.h"
 
 struct VarId {
 private:
     friend class SymbolTable;
 
-    std::optional<std::size_t> callable;
-    std::size_t block;
-    std::size_t index;
+    std::optional<std::uint32_t> callable;
+    std::uint32_t block;
+    std::uint32_t index;
 
 public:
     friend bool operator==(const VarId &l, const VarId &r)
@@ -24,7 +26,7 @@ private:
     friend class SymbolTable;
 
     NamePool::Id name;
-    std::size_t index;
+    std::uint32_t index;
 
 public:
     friend bool operator==(const FuncId &l, const FuncId &r)
@@ -32,6 +34,12 @@ public:
 
     friend bool operator!=(const FuncId &l, const FuncId &r)
     { return !(l == r); }
+
+    struct Hasher {
+        std::size_t operator()(const FuncId &id) const {
+            return leNiceHasheFunctione(NamePool::Id::Hasher()(id.name), id.index);
+        }
+    };
 };
 
 struct MacroId {
@@ -39,7 +47,7 @@ private:
     friend class SymbolTable;
 
     NamePool::Id name;
-    std::size_t index;
+    std::uint32_t index;
 
 public:
     friend bool operator==(const MacroId &l, const MacroId &r)
@@ -47,4 +55,10 @@ public:
 
     friend bool operator!=(const MacroId &l, const MacroId &r)
     { return !(l == r); }
+
+    struct Hasher {
+        std::size_t operator()(const MacroId &id) const {
+            return leNiceHasheFunctione(NamePool::Id::Hasher()(id.name), id.index);
+        }
+    };
 };
\ No newline at end of file
@@ -31,8 +31,8 @@ void TypeTable::TypeDescr::addDecor(Decor d, bool cn_) {
     decors.push_back(d);
     cns.push_back(false);
 
-    // if all of the elems are cn, the entire arr is cn
-    if (cn_ || (prevIsCn && d.type == Decor::D_ARR))
+    // if all of the elems are cn, the entire arr (or vec) is cn
+    if (cn_ || (prevIsCn && (d.type == Decor::D_ARR || d.type == Decor::D_VEC)))
         setLastCn();
 }
 
@@ -234,7 +234,7 @@ optional<TypeTable::Id> TypeTable::addTypeDerefOf(Id typeId) {
 }
 
 optional<TypeTable::Id> TypeTable::addTypeIndexOf(Id typeId) {
-    if (!worksAsTypeArrP(typeId) && !worksAsTypeArr(typeId)) return nullopt;
+    if (!worksAsTypeArrP(typeId) && !worksAsTypeArr(typeId) && !worksAsTypeVec(typeId)) return nullopt;
 
     if (isTypeDescr(typeId)) {
         const TypeDescr &typeDescr = typeDescrs[typeId.index].first;
@@ -289,6 +289,13 @@ TypeTable::Id TypeTable::addTypeArrOfLenIdOf(Id typeId, std::size_t len) {
     }
 }
 
+TypeTable::Id TypeTable::addTypeVecOfLenIdOf(Id typeId, std::size_t len) {
+    TypeDescr typeVecDescr(typeId);
+    typeVecDescr.addDecor({TypeDescr::Decor::D_VEC, len}, false);
+
+    return addTypeDescr(move(typeVecDescr));
+}
+
 TypeTable::Id TypeTable::addTypeCnOf(Id typeId) {
     if (isDirectCn(typeId)) return typeId;
 
@@ -420,6 +427,12 @@ optional<size_t> TypeTable::extractLenOfArr(Id arrTypeId) const {
     return getTypeDescr(baseTypeId).decors.back().len;
 }
 
+optional<size_t> TypeTable::extractLenOfVec(Id vecTypeId) const {
+    TypeTable::Id baseTypeId = extractExplicitTypeBaseType(vecTypeId);
+    if (!worksAsTypeVec(baseTypeId)) return nullopt;
+    return getTypeDescr(baseTypeId).decors.back().len;
+}
+
 optional<size_t> TypeTable::extractLenOfTuple(Id tupleTypeId) const {
     TypeTable::Id baseTypeId = extractExplicitTypeBaseType(tupleTypeId);
     if (!isTuple(baseTypeId)) return nullopt;
@@ -728,6 +741,12 @@ bool TypeTable::worksAsTypeArrP(Id t) const {
     });
 }
 
+bool TypeTable::worksAsTypeVec(Id t) const {
+    return worksAsTypeDescrSatisfyingCondition(t, [](const TypeDescr &ty) {
+        return !ty.decors.empty() && ty.decors.back().type == TypeDescr::Decor::D_VEC;
+    });
+}
+
 bool TypeTable::worksAsTypeStr(Id t) const {
     return worksAsTypeDescrSatisfyingCondition(t, [this](const TypeDescr &ty) {
         return ty.decors.size() == 1 && ty.decors[0].type == TypeDescr::Decor::D_ARR_PTR &&
@@ -750,7 +769,8 @@ bool TypeTable::worksAsTypeCn(Id t) const {
             for (size_t i = descr.cns.size()-1;; --i) {
                 if (descr.cns[i]) return true;
 
-                if (descr.decors[i].type != TypeDescr::Decor::D_ARR) return false;
+                if (descr.decors[i].type != TypeDescr::Decor::D_ARR &&
+                    descr.decors[i].type != TypeDescr::Decor::D_VEC) return false;
 
                 if (i == 0) break;
             }
@@ -1041,6 +1061,7 @@ optional<string> TypeTable::makeBinString(Id t, const NamePool *namePool, bool m
             if (descr.decors[ind].type == TypeDescr::Decor::D_ARR) ss << "$arr";
             else if (descr.decors[ind].type == TypeDescr::Decor::D_ARR_PTR) ss << "$[]";
             else if (descr.decors[ind].type == TypeDescr::Decor::D_PTR) ss << "$*";
+            else if (descr.decors[ind].type == TypeDescr::Decor::D_VEC) ss << "$vec" << descr.decors[ind].len;
             else return nullopt;
         }
         if (descr.cn) ss << "$cn";
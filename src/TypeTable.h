@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <optional>
 #include <unordered_map>
 #include <vector>
@@ -24,7 +25,7 @@ public:
         };
 
         Kind kind;
-        std::size_t index;
+        std::uint32_t index;
 
         Id(Kind k, std::size_t ind) : kind(k), index(ind) {}
 
@@ -61,6 +62,7 @@ public:
                 D_PTR,
                 D_ARR,
                 D_ARR_PTR,
+                D_VEC,
                 D_INVALID
             };
 
@@ -106,6 +108,8 @@ public:
         bool defined = false;
         NamePool::Id name;
         std::vector<ElemEntry> elements;
+        bool packed = false;
+        std::optional<std::uint64_t> align;
 
         DataType() {}
         DataType(NamePool::Id name, std::vector<ElemEntry> elems) : name(name), elements(std::move(elems)) {}
@@ -216,6 +220,7 @@ public:
     std::optional<Id> addTypeIndexOf(Id typeId);
     Id addTypeAddrOf(Id typeId);
     Id addTypeArrOfLenIdOf(Id typeId, std::size_t len);
+    Id addTypeVecOfLenIdOf(Id typeId, std::size_t len);
     Id addTypeCnOf(Id typeId);
 
     Id addTypeDescrForSig(const TypeDescr &typeDescr);
@@ -272,6 +277,7 @@ public:
     bool worksAsTypeArr(Id t) const;
     bool worksAsTypeArrOfLen(Id t, std::size_t len) const;
     bool worksAsTypeArrP(Id t) const;
+    bool worksAsTypeVec(Id t) const;
     bool worksAsTypeStr(Id t) const;
     bool worksAsTypeCharArrOfLen(Id t, std::size_t len) const;
     bool worksAsTypeCn(Id t) const;
@@ -281,6 +287,7 @@ public:
     const Callable* extractCallable(Id callTypeId) const;
 
     std::optional<std::size_t> extractLenOfArr(Id arrTypeId) const;
+    std::optional<std::size_t> extractLenOfVec(Id vecTypeId) const;
     std::optional<std::size_t> extractLenOfTuple(Id tupleTypeId) const;
     std::optional<std::size_t> extractLenOfDataType(Id dataTypeId) const;
 
@@ -2,6 +2,7 @@
 #include <iostream>
 #include "CompilationOrchestrator.h"
 #include "exceptions.h"
+#include "llvm/Support/Threading.h"
 #include "ProgramArgs.h"
 using namespace std;
 
@@ -14,6 +15,9 @@ enum ProgramError {
     INTERNAL = 100
 };
 
+// evaluation recurses on the native stack, so processing gets more of it than the main thread usually has
+const unsigned PROCESS_STACK_SIZE = 256 << 20;
+
 int main(int argc,  char** argv) {
     optional<ProgramArgs> programArgs = ProgramArgs::parseArgs(argc, argv, cerr);
     if (!programArgs.has_value()) {
@@ -23,12 +27,29 @@ int main(int argc,  char** argv) {
 
     CompilationOrchestrator co(move(programArgs.value()), cerr);
 
-    try {
-        if (!co.process()) {
-            cerr << "Processing failed." << endl;
-            return co.isInternalError() ? INTERNAL : PROCESS_FAIL;
+    bool processed = false, jumpedOut = false;
+    auto process = [&]() {
+        try {
+            processed = co.process();
+        } catch (ExceptionEvaluatorJump ex) {
+            jumpedOut = true;
         }
+    };
+    // the thread is only there for its stack size, so it is joined right away and nothing recovers from crashes on it
+    llvm::llvm_execute_on_thread([](void *userData) {
+        (*static_cast<decltype(process)*>(userData))();
+    }, &process, PROCESS_STACK_SIZE);
+    co.printEvalProfile(cerr);
+    if (jumpedOut) {
+        cerr << "Something went wrong when compiling!" << endl;
+        return INTERNAL;
+    }
+    if (!processed) {
+        cerr << "Processing failed." << endl;
+        return co.isInternalError() ? INTERNAL : PROCESS_FAIL;
+    }
 
+    try {
         if (!co.compile()) {
             cerr << "Compilation failed." << endl;
             return co.isInternalError() ? INTERNAL : COMPILE_FAIL;
@@ -5,6 +5,8 @@ using namespace std;
 std::unordered_map<NamePool::Id, Meaningful, NamePool::Id::Hasher> meaningfuls;
 std::unordered_map<NamePool::Id, Keyword, NamePool::Id::Hasher> keywords;
 std::unordered_map<NamePool::Id, Oper, NamePool::Id::Hasher> opers;
+std::array<NamePool::Id, (std::size_t) Attr::UNKNOWN> attrNameIds;
+std::unordered_map<NamePool::Id, AtomicOp, NamePool::Id::Hasher> atomicOps;
 
 const unordered_map<Oper, OperInfo> operInfos = {
     {Oper::ASGN, {.binary=true}},
@@ -106,6 +108,7 @@ bool isReserved(NamePool::Id name) {
 }
 
 bool isTypeDescrDecor(Meaningful m) {
+    // vec is only recognized as the head of (vec <len>), so it is not reserved
     return m == Meaningful::CN || m == Meaningful::ASTERISK || m == Meaningful::SQUARE;
 }
 
@@ -113,4 +116,14 @@ bool isTypeDescrDecor(NamePool::Id name) {
     optional<Meaningful> m = getMeaningful(name);
     if (!m.has_value()) return false;
     return isTypeDescrDecor(m.value());
+}
+
+NamePool::Id getAttrNameId(Attr a) {
+    return attrNameIds[(size_t) a];
+}
+
+optional<AtomicOp> getAtomicOp(NamePool::Id name) {
+    auto loc = atomicOps.find(name);
+    if (loc == atomicOps.end()) return nullopt;
+    return loc->second;
 }
\ No newline at end of file
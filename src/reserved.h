@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <optional>
 #include <unordered_map>
 #include "NamePool.h"
@@ -9,6 +10,7 @@ enum class Meaningful {
     CN,
     ASTERISK,
     SQUARE,
+    VEC,
     TYPE,
     UNKNOWN
 };
@@ -20,6 +22,8 @@ enum class Keyword {
     EXIT,
     LOOP,
     PASS,
+    BRANCH,
+    ATOMIC,
     EXPLICIT,
     DATA,
     FNC,
@@ -62,6 +66,67 @@ enum class Oper {
     UNKNOWN
 };
 
+// built-in attribute names, they are not reserved
+enum class Attr {
+    BARE,
+    GLOBAL,
+    EVALUATED,
+    NO_ZERO,
+    THREAD_LOCAL,
+    ALIGN,
+    PACKED,
+    NO_NAME_MANGLE,
+    EVALUABLE,
+    COMPILABLE,
+    INLINE,
+    NO_INLINE,
+    FLATTEN,
+    HOT,
+    COLD,
+    PURE,
+    NO_RETURN,
+    MEMOIZE,
+    VARIADIC,
+    NO_DROP,
+    NO_ALIAS,
+    PREPROCESS,
+    PLUS_ESCAPE,
+    WARNING,
+    ERROR,
+    LOC,
+    NO_WRAP,
+    LIKELY,
+    UNLIKELY,
+    VECTORIZE,
+    UNROLL,
+    NO_UNROLL,
+    INTERLEAVE,
+    PARALLEL_ACCESSES,
+    RELAXED,
+    ACQUIRE,
+    RELEASE,
+    ACQ_REL,
+    SEQ_CST,
+    WEAK,
+    UNKNOWN
+};
+
+// operations of the atomic special form, they are not reserved
+enum class AtomicOp {
+    LOAD,
+    STORE,
+    XCHG,
+    ADD,
+    SUB,
+    AND,
+    OR,
+    XOR,
+    MIN,
+    MAX,
+    CMPXCHG,
+    FENCE
+};
+
 struct OperInfo {
     bool unary = false;
     bool binary = false;
@@ -72,6 +137,9 @@ extern std::unordered_map<NamePool::Id, Meaningful, NamePool::Id::Hasher> meanin
 extern std::unordered_map<NamePool::Id, Keyword, NamePool::Id::Hasher> keywords;
 extern std::unordered_map<NamePool::Id, Oper, NamePool::Id::Hasher> opers;
 extern const std::unordered_map<Oper, OperInfo> operInfos;
+extern std::unordered_map<NamePool::Id, AtomicOp, NamePool::Id::Hasher> atomicOps;
+// indexed by Attr, so that attribute lookups don't need to intern strings
+extern std::array<NamePool::Id, (std::size_t) Attr::UNKNOWN> attrNameIds;
 
 bool isMeaningful(NamePool::Id name);
 std::optional<Meaningful> getMeaningful(NamePool::Id name);
@@ -87,4 +155,6 @@ NamePool::Id getOperNameId(Oper o);
 bool isOper(NamePool::Id name, Oper o);
 bool isReserved(NamePool::Id name);
 bool isTypeDescrDecor(Meaningful m);
-bool isTypeDescrDecor(NamePool::Id name);
\ No newline at end of file
+bool isTypeDescrDecor(NamePool::Id name);
+NamePool::Id getAttrNameId(Attr a);
+std::optional<AtomicOp> getAtomicOp(NamePool::Id name);
\ No newline at end of file
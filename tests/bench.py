@@ -0,0 +1,135 @@
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+ORBC_EXE = sys.argv[1]
+RUNS = 10
+
+TEST_BIN_DIR = 'bin'
+EMPTY_SRC = 'util/empty.orb'
+
+
+def write_attr_nodes(f):
+    # a large body under several levels of macro-generated attributed blocks
+    f.write('mac wrap (body) {\n')
+    f.write('    ret \\(block ,body)::((wrapped true));\n')
+    f.write('};\n\n')
+    f.write('fnc main () () {\n')
+    f.write('    sym x:i32;\n')
+    for i in range(8):
+        f.write('    wrap {\n')
+    for i in range(20000):
+        f.write('        = x (+ x:i32 {});\n'.format(i % 100))
+    for i in range(8):
+        f.write('    };\n')
+    f.write('};\n')
+
+
+def write_hole_free_quote(f):
+    # a macro quoting a large template without holes, whose expansion is left unused
+    f.write('mac tmpl () {\n')
+    f.write('    sym (code \\{\n')
+    for i in range(50):
+        f.write('        (= y (+ (* y 3) (- {} (/ 8 2))))\n'.format(i % 100))
+    f.write('    });\n')
+    f.write('    ret ();\n')
+    f.write('};\n\n')
+    f.write('fnc main () () {\n')
+    for i in range(2000):
+        f.write('    tmpl;\n')
+    f.write('};\n')
+
+
+def write_memory(f):
+    # a large parsed body plus a large body generated by a macro
+    f.write('mac gen (n::preprocess) {\n')
+    f.write('    sym (code {}) (i 0:u32);\n')
+    f.write('    block {\n')
+    f.write('        exit (>= i n);\n')
+    f.write('        = code (+ code \\{(= x (+ x:i32 (* x:i32 2:i32)))});\n')
+    f.write('        = i (+ i 1);\n')
+    f.write('        loop true;\n')
+    f.write('    };\n')
+    f.write('    ret \\(block ,code);\n')
+    f.write('};\n\n')
+    f.write('fnc main () () {\n')
+    f.write('    sym x:i32;\n')
+    for i in range(50000):
+        f.write('    = x (+ x:i32 {});\n'.format(i % 100))
+    f.write('    gen 50000;\n')
+    f.write('};\n')
+
+
+# name -> (description, source writer or None to compile the empty file)
+BENCHES = {
+    'startup': ('an empty file', None),
+    'attr_nodes': ('20000 statements under 8 attributed blocks', write_attr_nodes),
+    'hole_free_quote': ('2000 quotes of a 50-statement template without holes', write_hole_free_quote),
+    'memory': ('50000 parsed and 50000 macro-generated statements', write_memory),
+}
+
+
+# returns time in seconds and peak memory in kilobytes (None where not reported), or None on failure
+def measure_run(src_file, obj_file):
+    start = time.perf_counter()
+    proc = subprocess.Popen([ORBC_EXE, src_file, '-c', '-o', obj_file])
+    if hasattr(os, 'wait4'):
+        _, status, usage = os.wait4(proc.pid, 0)
+        returncode = os.waitstatus_to_exitcode(status)
+        # reported in kilobytes on Linux
+        peak = usage.ru_maxrss
+    else:
+        returncode = proc.wait()
+        peak = None
+    end = time.perf_counter()
+
+    if returncode != 0:
+        return None
+    return end - start, peak
+
+
+def run_bench(name):
+    desc, write_source = BENCHES[name]
+
+    if write_source is None:
+        src_file = EMPTY_SRC
+    else:
+        src_file = TEST_BIN_DIR + '/bench_' + name + '.orb'
+        with open(src_file, 'w') as f:
+            write_source(f)
+    obj_file = TEST_BIN_DIR + '/bench_' + name + '.o'
+
+    times = []
+    peaks = []
+    for i in range(RUNS):
+        measured = measure_run(src_file, obj_file)
+        if measured is None:
+            return False
+        times.append(measured[0])
+        peaks.append(measured[1])
+
+    report = '{}: compiling {} over {} runs: min {:.2f} ms, median {:.2f} ms'.format(
+        name, desc, RUNS, min(times) * 1000, statistics.median(times) * 1000)
+    if peaks[0] is not None:
+        report += ', peak memory {:.1f} MB'.format(max(peaks) / 1024)
+    print(report)
+
+    return True
+
+
+if __name__ == "__main__":
+    names = sys.argv[2:] if len(sys.argv) > 2 else list(BENCHES)
+    for name in names:
+        if name not in BENCHES:
+            print('Unknown benchmark: ' + name)
+            sys.exit(1)
+
+    if not os.path.exists(TEST_BIN_DIR):
+        os.mkdir(TEST_BIN_DIR)
+
+    for name in names:
+        if not run_bench(name):
+            print('Compilation failed!')
+            sys.exit(1)
@@ -16,6 +16,41 @@ TEST_LIB_DIR = '../libs/'
 TESTS_POS_SILENT = ['test_message']
 
 
+def check_ir(case, ir_cmp_file):
+    # each line of ir_cmp_file is a regex that must match some line of the emitted LLVM IR
+    # lines starting with 'NOT ' instead hold a regex that must match no line
+    ir_file = TEST_BIN_DIR + '/' + case + '.ll'
+    os.replace(case + '.ll', ir_file)
+
+    with open(ir_file, 'r') as file:
+        ir_out = file.read().splitlines()
+
+    with open(ir_cmp_file, 'r') as file:
+        ir_cmp = file.read().splitlines()
+
+    success = True
+    for expected in ir_cmp:
+        if expected.startswith('NOT '):
+            if any(re.search(expected[4:], line) for line in ir_out):
+                print('Found in ' + ir_file + ': ' + expected[4:])
+                success = False
+        elif not any(re.search(expected, line) for line in ir_out):
+            print('Not found in ' + ir_file + ': ' + expected)
+            success = False
+
+    return success
+
+
+def read_extra_args(dir, case):
+    # <case>.args holds extra orbc arguments for that test, separated by whitespace
+    args_file = dir + '/' + case + '.args'
+    if not os.path.exists(args_file):
+        return []
+
+    with open(args_file, 'r') as file:
+        return file.read().split()
+
+
 def run_positive_test(case):
     print('Positive test: ' + case)
 
@@ -25,14 +60,22 @@ def run_positive_test(case):
     if platform.system() == 'Windows':
         exe_file += '.exe'
     cmp_file = TEST_POS_DIR + '/' + case + '.txt'
+    ir_cmp_file = TEST_POS_DIR + '/' + case + '.ll.txt'
+
+    orbc_args = [ORBC_EXE, src_file, lib_path, '-o', exe_file] + read_extra_args(TEST_POS_DIR, case)
+    if os.path.exists(ir_cmp_file):
+        orbc_args.append('-emit-llvm')
 
     if case in TESTS_POS_SILENT:
-        result = subprocess.run([ORBC_EXE, src_file, lib_path, '-o', exe_file], stderr=subprocess.DEVNULL)
+        result = subprocess.run(orbc_args, stderr=subprocess.DEVNULL)
     else:
-        result = subprocess.run([ORBC_EXE, src_file, lib_path, '-o', exe_file])
+        result = subprocess.run(orbc_args)
     if result.returncode != 0:
         return False
 
+    if os.path.exists(ir_cmp_file) and not check_ir(case, ir_cmp_file):
+        return False
+
     result = subprocess.run(exe_file, stdout=subprocess.PIPE)
     exe_out = result.stdout.decode('utf-8').splitlines()
 
@@ -56,7 +99,9 @@ def run_negative_test(case):
     if platform.system() == 'Windows':
         exe_file += '.exe'
 
-    result = subprocess.run([ORBC_EXE, src_file, lib_path, '-o', exe_file], stderr=subprocess.DEVNULL)
+    orbc_args = [ORBC_EXE, src_file, lib_path, '-o', exe_file] + read_extra_args(TEST_NEG_DIR, case)
+
+    result = subprocess.run(orbc_args, stderr=subprocess.DEVNULL)
     return result.returncode > 0 and result.returncode < 100
 
 